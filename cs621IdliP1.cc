@@ -12,18 +12,261 @@
 #include <sstream> 
 #include <stdlib.h>
 #include <tuple>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include <iomanip>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("cs621P1Idli - NS3 Compression Detection Application");
 
 void
-generateRandomPayloadFile(void);
+generateRandomPayloadFile(uint64_t);
+
+// What a run writes to pcap files
+struct PcapOptions {
+	bool enabled = true;                // capture this run at all
+	std::string devices = "all";        // all, ndc12 or comma separated device indices 0-5
+	uint32_t snapLen = 65535;           // bytes kept per frame
+	uint32_t sample = 1;                // keep one frame in every sample per device
+	bool gzip = false;                  // write .pcap.gz files
+};
+
+// Settings of one simulation run
+struct SimulationConfig {
+	std::string pcapPrefix = "p1_";
+	double dataRate = 1;                // ndc12 data rate in Mbps
+	bool compression = false;           // compress on the ndc12 link
+	bool highEntropy = false;           // send random instead of all-zero payloads
+	std::string codec = "deflate";      // ndc12 codec: deflate or re
+	std::string payloadFile = "randomPayload.txt"; // high entropy bits, empty to use the RNG
+	uint32_t compressionThreads = 0;    // deflate worker threads on ndc12
+	int compressionLevel = 9;           // deflate level on ndc12, 0 sends uncompressed, -1 adaptive
+	std::string compressionDomain = "link"; // deflate on ndc12 only, or "path": client egress to server ingress
+	bool duplex = false;                // codec in both directions and a reverse flow from node 3 to node 0
+	uint32_t reverseSize = 64;          // reverse flow packet size in bytes, SeqTsHeader included
+	uint32_t links = 1;                 // ndc12 member links, each at dataRate; above 1 a Multilink PPP bundle
+	uint32_t packetCount = 6000;        // packets sent by the client
+	uint32_t packetSize = 1112;         // client packet size in bytes, SeqTsHeader included
+	double interval = 0;                // client inter-packet gap in us, 0 sends the whole flow at once
+	uint32_t burst = 0;                 // packets per client send event, 0 = whole flow if unpaced, else 1
+	uint32_t flows = 1;                 // concurrent client/server pairs through ndc12
+	std::string flowEntropy;            // l or h per extra flow, cycled; empty = the run's entropy
+	double flowStagger = 0;             // ms between the starts of consecutive flows
+	std::string traceFile;              // pcap or text trace replayed by every client, empty for none
+	double traceScale = 1;              // factor applied to the trace's inter-packet gaps
+	double entropy = -1;                // high entropy payload in bits per byte, 0-8; -1 for ASCII bits
+	std::string phases;                 // high entropy workload phases, bits:packets,...; empty for none
+	PcapOptions pcap;                   // capture settings, not part of the result
+	bool latencyTag = false;            // per hop delay breakdown in Latency.txt
+	double queueResolution = 0;         // ndc12 queue time series interval in ms, 0 for none
+	bool statsFiles = false;            // measured server's delay statistics in stats_*.txt
+	Ptr<CompressionDetector> detector;  // online detector on the server, may be null
+};
+
+// Outcome of one flow of a multi-flow run
+struct FlowResult {
+	uint32_t flow;            // index, 0 is the measured flow
+	bool highEntropy;
+	uint64_t received;
+	uint64_t lost;
+	double throughput;        // Mbps between the first and last arrival
+	double delayMean;         // us
+};
+
+// Outcome of one simulation run
+struct SimulationResult {
+	Time deltaTime;           // arrival spread measured by the UdpServer
+	uint64_t codecBytesIn;    // payload bytes entering the ndc12 egress codec
+	uint64_t codecBytesOut;   // payload bytes leaving the ndc12 egress codec
+	uint64_t codecPackets;    // frames rebuilt by the codec on both ends of ndc12
+	int32_t compressionLevel; // deflate level on ndc12 at the end of the run, 0 when not compressing
+	uint64_t transitFrames;   // compressed frames routers sent on without expanding them, once per router
+	uint64_t reverseReceived; // packets of the reverse flow received, 0 without duplex
+	double reverseDelayMean;  // us
+	uint64_t reverseCodecBytesIn;  // reverse payload bytes entering the codec
+	uint64_t reverseCodecBytesOut; // reverse payload bytes leaving the codec
+	uint64_t lostFragments;   // Multilink fragments lost on ndc12, both directions; 0 with one link
+	uint64_t received;        // packets received by the server
+	uint64_t lost;            // sequence numbers never received
+	uint64_t reordered;       // packets received after a higher sequence number
+	double delayMean;         // one-way delay statistics in us
+	double delayP50;
+	double delayP99;
+	double delayMax;
+	double goodput;           // Mbps received by all flows together
+	double fairness;          // Jain's index of the flow throughputs, 1 for one flow
+	std::vector<FlowResult> flows; // per flow, only with several flows; not journaled
+};
+
+SimulationResult
+makeSimulation(const SimulationConfig &);
+
+// Pcap file a device is currently written to
+struct PcapTarget : public SimpleRefCount<PcapTarget> {
+	Ptr<AsyncPcapWriter> file;  // null between experiments or when not captured
+	Time origin;                // start of the experiment writing the file
+	uint32_t sample = 1;        // write one frame in sample
+	uint64_t seen = 0;          // frames seen since the file was opened
+};
+
+bool
+captureDevice(const std::string &, uint32_t);
+
+// Nodes, links and addresses of one 4 node topology, built once and
+// reconfigured for every experiment that runs on it
+struct Topology {
+	NodeContainer nodes;
+	NetDeviceContainer devices;         // ndc01, ndc12 and ndc23 devices
+	Ptr<PointToPointNetDevice> ppp1;    // ndc12, compressing end; first member of a bundle
+	Ptr<PointToPointNetDevice> ppp2;    // ndc12, decompressing end; first member of a bundle
+	Ptr<MultilinkPppNetDevice> bundle1; // ndc12 bundle ends with more than one link, else null
+	Ptr<MultilinkPppNetDevice> bundle2;
+	Ipv4Address serverAddress;
+	Ipv4Address clientAddress;          // node 0, target of the reverse flow
+	uint16_t nextPort;                  // server port of the next experiment
+	std::vector<Ptr<PcapTarget> > pcap; // one per device
+};
+
+// One experiment inside a (possibly shared) Simulator run
+struct Experiment {
+	Ptr<UdpServer> server;              // server of flow 0, the measured flow
+	std::vector<Ptr<UdpServer> > servers; // every flow's server, in flow order
+	std::vector<bool> highEntropy;      // entropy of every flow
+	Ptr<PointToPointNetDevice> ppp1;
+	Ptr<PointToPointNetDevice> ppp2;
+	Ptr<MultilinkPppNetDevice> bundle1; // run the ndc12 codec instead of ppp1 and ppp2, may be null
+	Ptr<MultilinkPppNetDevice> bundle2;
+	Ptr<PointToPointNetDevice> encoder; // egress codec of the compression domain
+	Ptr<PointToPointNetDevice> decoder; // ingress codec of the compression domain
+	std::vector<Ptr<PointToPointNetDevice> > transit; // devices forwarding compressed frames
+	Ptr<UdpServer> reverseServer;       // server of the reverse flow, null without duplex
+	std::vector<Ptr<PcapTarget> > pcap;
+};
+
+Experiment
+buildExperiment(const SimulationConfig &, uint32_t);
+
+Topology
+buildTopology(uint32_t, uint32_t);
+
+NetDeviceContainer
+installBundle(Ptr<Node>, Ptr<Node>, uint32_t);
+
+Experiment
+installExperiment(Topology &, const SimulationConfig &);
+
+// Topology reused by consecutive runs with --reuseTopology, built on first use
+bool reuseTopology = false;
+Topology *sharedTopology = nullptr;
+
+SimulationResult
+collectResult(const Experiment &);
+
+std::vector<SimulationResult>
+makeBatch(const std::vector<SimulationConfig> &);
+
+// Outcome of one low/high entropy pair
+struct PairResult {
+	int64_t delta;            // high minus low entropy dispersion in ms
+	bool detected;
+	SimulationResult low;
+	SimulationResult high;
+};
+
+// Outcome of all trials at one data rate
+struct RateDecision {
+	double mean;              // mean delta in ms
+	double lower;             // confidence bounds of the mean delta
+	double upper;
+	uint32_t trials;          // number of pairs simulated
+	bool detected;            // false when inconclusive
+	bool inconclusive;        // maxTrials ran out with the interval straddling the threshold
+	bool cached;              // every pair was reused from the result cache
+};
+
+// dispersion increase, in ms, above which compression is detected
+const int64_t detectionThreshold = 100;
+
+PairResult
+runPair(SimulationConfig, bool);
+
+RateDecision
+runTrials(SimulationConfig, bool, uint32_t, uint32_t, double);
+
+// Pairs completed by earlier invocations, keyed by a hash of everything
+// that determines their outcome.  Every new pair is appended to the
+// journal file as soon as it finishes, so an interrupted or widened sweep
+// only simulates the points it is missing.
+std::string resultCacheFile = "ResultCache.txt";
+std::map<uint64_t, PairResult> resultCache;
+
+void
+loadResultCache(void);
+
+uint64_t
+pairKey(const SimulationConfig &, bool);
+
+bool
+cachedPair(const SimulationConfig &, bool, PairResult &);
+
+bool
+lookupPair(uint64_t, PairResult &);
+
+void
+storePair(uint64_t, const PairResult &);
+
+// How every data rate of a sweep or search is evaluated
+struct SweepOptions {
+	SimulationConfig base;              // settings shared by every run
+	bool earlyStop = false;             // online detector with early stop
+	uint32_t minTrials = 3;             // pairs before the interval may stop the trials
+	uint32_t maxTrials = 1;             // maximum pairs per rate
+	double confidence = 0.95;           // confidence level of the decision
+	uint32_t batch = 1;                 // experiments sharing one Simulator run
+	std::string pcapRates;              // comma separated rates to capture, empty for all
+};
 
-Time
-makeSimulation(std::string, std::string, bool, bool, int);
+bool
+captureRate(const SweepOptions &, double);
+
+RateDecision
+evaluateRate(const SweepOptions &, double);
+
+void
+searchThreshold(const SweepOptions &, double, double, double);
+
+void
+sweepBatched(const SweepOptions &, int, int);
+
+void
+reportRate(const SweepOptions &, double, const RateDecision &);
+
+void
+printCodecStats(const SimulationConfig &, const PairResult &);
 
-void writeToFile(int, int64_t);
+std::string
+rateLabel(double);
+
+// Structured results: one row per simulated run in Runs.csv and one per
+// rate decision in Rates.csv, buffered and appended with whole-row writes
+Ptr<ResultsSink> runSink;
+Ptr<ResultsSink> rateSink;
+Ptr<ResultsSink> flowSink;          // Flows.csv, opened by the first multi-flow run
+bool resultsBinary = false;
+
+void
+openResults(bool);
+
+void
+recordRun(const SimulationConfig &, const SimulationResult &);
+
+void
+recordRate(const SimulationConfig &, double, const RateDecision &);
 
 
 std::tuple<int, int, int, std::string>
@@ -46,22 +289,25 @@ readConfigParamaters(std::string cfFileName){
 }
 
 
+// Writes bits random bits as ASCII, in chunks so any size fits in memory.
+// The client rewinds the file at its end, so it may be shorter than a flow.
 void
-generateRandomPayloadFile() {
+generateRandomPayloadFile(uint64_t bits) {
 	std::uniform_int_distribution<int> d(0, 1);
-	std::stringstream s;
-
 	std::ofstream randomPayloadFile;
 
 	std::cout<<"Generating random bits and outputing to file" << std::endl;
 	randomPayloadFile.open ("randomPayload.txt");
 
 	std::random_device rd2("/dev/random"); 
-	for(int pc = 0; pc < 6000*1100 + 5; pc++) {
-		s << d(rd2);
+	std::string chunk;
+	for(uint64_t pc = 0; pc < bits; pc += chunk.size()) {
+		chunk.assign(std::min<uint64_t>(bits - pc, 1 << 20), '0');
+		for (size_t i = 0; i < chunk.size(); i++) {
+			chunk[i] = '0' + d(rd2);
+		}
+		randomPayloadFile << chunk;
 	}
-	randomPayloadFile << s.str();
-	s.str("");
 	randomPayloadFile.close();
 	std::cout<<"Random bits generation complete" << std::endl;
 }
@@ -76,7 +322,46 @@ main(int argc, char *argv[])
 
 	CommandLine cmd;
 	std::string cfFileName; 
+	SweepOptions options;
+	std::string search = "sweep";
+	double resolution = 0.1;
 	cmd.AddValue("cfFileName", "config file name", cfFileName);
+	cmd.AddValue("codec", "link codec used when compression is on: deflate or re (redundancy elimination)", options.base.codec);
+	cmd.AddValue("compressionThreads", "worker threads compressing queued packets on the ndc12 link (0 = inline)", options.base.compressionThreads);
+	cmd.AddValue("compressionLevel", "deflate level on the ndc12 link, 1-9 (0 = send uncompressed, -1 = adaptive from queue depth and utilization)", options.base.compressionLevel);
+	cmd.AddValue("compressionDomain", "link: deflate on ndc12 only; path: deflate at the client's egress, routers forward compressed frames, inflate at the server's ingress", options.base.compressionDomain);
+	cmd.AddValue("duplex", "compress both directions of the link, each end with its own codec state, and send a reverse flow from the server side", options.base.duplex);
+	cmd.AddValue("reverseSize", "packet size of the --duplex reverse flow in bytes, 12 byte header included (64 = acknowledgement sized)", options.base.reverseSize);
+	cmd.AddValue("links", "parallel links of the ndc12 bottleneck, each at the run's data rate, bundled with Multilink PPP (1 = a single link)", options.base.links);
+	cmd.AddValue("earlyStop", "stop each run as soon as the online detector is confident", options.earlyStop);
+	cmd.AddValue("maxTrials", "maximum low/high pairs per rate, each with its own RngRun (1 = single pair)", options.maxTrials);
+	cmd.AddValue("minTrials", "pairs per rate before the confidence interval may stop the trials", options.minTrials);
+	cmd.AddValue("confidence", "confidence level of the per-rate decision", options.confidence);
+	cmd.AddValue("search", "sweep: every integer rate from min to max; bisection: search the detection crossover", search);
+	cmd.AddValue("resolution", "rate resolution of the bisection search in Mbps", resolution);
+	cmd.AddValue("batch", "low/high entropy experiments run side by side in one simulation (sweep without trials or early stop)", options.batch);
+	cmd.AddValue("reuseTopology", "build the nodes, stacks and routes once; every experiment still installs its own applications (no early stop)", reuseTopology);
+	cmd.AddValue("pcapDevices", "devices captured: all, ndc12, none or comma separated indices 0-5", options.base.pcap.devices);
+	cmd.AddValue("snapLen", "bytes of each frame kept in the pcap files (64 keeps the headers only)", options.base.pcap.snapLen);
+	cmd.AddValue("pcapSample", "capture one frame in N on each device", options.base.pcap.sample);
+	cmd.AddValue("pcapGzip", "gzip the pcap files while they are written", options.base.pcap.gzip);
+	cmd.AddValue("pcapRates", "comma separated rates whose runs are captured (empty = every rate)", options.pcapRates);
+	cmd.AddValue("latencyTag", "tag packets and write the per hop delay breakdown to Latency.txt", options.base.latencyTag);
+	cmd.AddValue("queueResolution", "sample the ndc12 queue into queue_*.bin at this interval in ms (0 = off)", options.base.queueResolution);
+	cmd.AddValue("statsFiles", "append the measured server's delay and inter-arrival statistics of every run to stats_*.txt", options.base.statsFiles);
+	cmd.AddValue("packets", "packets sent by the client of every run", options.base.packetCount);
+	cmd.AddValue("packetSize", "client packet size in bytes, including the 12 byte sequence and timestamp header", options.base.packetSize);
+	cmd.AddValue("interval", "client inter-packet gap in us (0 = whole flow at once; pace long runs to keep the queues short)", options.base.interval);
+	cmd.AddValue("burst", "packets the client sends per scheduler event (0 = the whole flow when --interval is 0, else 1)", options.base.burst);
+	cmd.AddValue("flows", "concurrent client/server pairs through the bottleneck, flow 0 is measured", options.base.flows);
+	cmd.AddValue("flowEntropy", "entropy of flows 1 and up, l or h per flow, cycled (empty = same as flow 0)", options.base.flowEntropy);
+	cmd.AddValue("flowStagger", "ms between the starts of consecutive flows", options.base.flowStagger);
+	cmd.AddValue("traceFile", "pcap or \"time size\" text trace replayed by the clients instead of generated payloads", options.base.traceFile);
+	cmd.AddValue("traceScale", "factor applied to the trace's inter-packet gaps (0 = back to back)", options.base.traceScale);
+	cmd.AddValue("entropy", "payload entropy of the high entropy runs in bits per byte, 0 to 8 (-1 = ASCII bits from the payload file)", options.base.entropy);
+	cmd.AddValue("phases", "workload phases of the high entropy runs as bits:packets pairs, e.g. 0:2000,8:2000,0:2000", options.base.phases);
+	cmd.AddValue("resultCache", "journal of completed runs reused by later sweeps (empty = always simulate)", resultCacheFile);
+	cmd.AddValue("resultsBinary", "also write Runs.col and Rates.col, columnar binary copies of the csv files", resultsBinary);
 	cmd.Parse (argc, argv);
 	if(cfFileName.empty()){
 		std::cout<<"Config file not given: command is ./waf --run 'cs621P1Idli --cfFileName=config.txt'" << std::endl;
@@ -98,62 +383,881 @@ main(int argc, char *argv[])
 			std::cout<<"Compression:" << compressionFlag << std::endl;
 			std::cout<<"minDataRate:" << minDataRate << std::endl;
 			std::cout<<"maxDataRate:" << maxDataRate << std::endl;
-			std::cout<<"protocol:" << protocol << std::endl<< std::endl;
-
-			//generateRandomPayloadFile();	/// remove this comment when project ready idli
-
-			
-			for(int i = minDataRate; i<=maxDataRate; i++)	{ // data rate change here
-
-				Time lowEDT = makeSimulation("p1_", std::string (std::to_string(i)+"Mbps"), compressionFlag, false, i);
-				Time highEDT = makeSimulation("p1_", std::string (std::to_string(i)+"Mbps"), compressionFlag, true, i);
-				int64_t delta = highEDT.GetMilliSeconds() - lowEDT.GetMilliSeconds();
-				writeToFile(i, delta);
-	
-				if (highEDT.GetMilliSeconds() - lowEDT.GetMilliSeconds() >= 100) {
-						std::cout << "Compression detected at datarate "<< std::to_string(i)<<" Mbps, coz delta time is "<< delta <<" ms"<< "\n\n";
-				} else {
-						std::cout << "Not detected at datarate "<< std::to_string(i)<<" Mbps, coz delta time is "<< delta <<" ms"<< "\n\n";
+			std::cout<<"protocol:" << protocol << std::endl;
+			std::cout<<"codec:" << options.base.codec << std::endl<< std::endl;
+
+			//generateRandomPayloadFile((uint64_t) options.base.packetCount * (options.base.packetSize - 12));	/// remove this comment when project ready idli
+
+			// an unpaced flow is queued whole at the sender, a paced one
+			// keeps the queues, and the memory, bounded
+			uint64_t flowPackets = (uint64_t) options.base.packetCount * std::max<uint32_t>(options.base.flows, 1);
+			uint32_t queuePackets = options.base.interval > 0 ? 6000 : std::max<uint64_t>(flowPackets, 6000);
+			Config::SetDefault("ns3::QueueBase::MaxSize", StringValue (std::to_string(queuePackets) + "p"));
+
+			options.base.compression = compressionFlag;
+			if (options.maxTrials > 1) {
+				// every trial needs its own high entropy data
+				options.base.payloadFile = "";
+			}
+
+			loadResultCache();
+			openResults(resultsBinary);
+
+			if (options.base.compressionDomain != "link" && (options.base.compressionDomain != "path" || options.base.codec == "re")) {
+				// redundancy eliminated frames cannot be routed as they are
+				std::cout << "--compressionDomain=" << options.base.compressionDomain << " ignored: only deflate runs on a path" << "\n\n";
+				options.base.compressionDomain = "link";
+			}
+
+			options.base.links = std::max<uint32_t>(options.base.links, 1);
+			if (options.base.links > 1) {
+				// the bundle deflates whole frames at a fixed level, before striping
+				if (options.base.codec == "re") {
+					std::cout << "--codec=re ignored: a bundle of links only deflates" << "\n\n";
+					options.base.codec = "deflate";
+				}
+				if (options.base.compressionDomain != "link") {
+					std::cout << "--compressionDomain=" << options.base.compressionDomain << " ignored: routers do not forward compressed bundle frames" << "\n\n";
+					options.base.compressionDomain = "link";
 				}
+				if (options.base.compressionLevel < 0) {
+					std::cout << "--compressionLevel=-1 ignored: a bundle of links deflates at a fixed level" << "\n\n";
+					options.base.compressionLevel = 9;
+				}
+			}
+
+			// the reverse client needs room for its sequence and timestamp header
+			options.base.reverseSize = std::max<uint32_t>(options.base.reverseSize, 12);
+
+			if (reuseTopology && options.earlyStop) {
+				// the detector stops the simulator with the flows still queued
+				std::cout << "--reuseTopology ignored: early stop needs runs of their own" << "\n\n";
+				reuseTopology = false;
+			}
+
+			if (search == "bisection") {
+				searchThreshold(options, minDataRate, maxDataRate, resolution);
+			} else if (options.batch > 1 && options.maxTrials <= 1 && !options.earlyStop && !reuseTopology) {
+				sweepBatched(options, minDataRate, maxDataRate);
+			} else {
+				if (options.batch > 1) {
+					std::cout << "--batch ignored: trials, early stop and a reused topology need runs of their own" << "\n\n";
+				}
+				for(int i = minDataRate; i<=maxDataRate; i++)	{ // data rate change here
+					evaluateRate(options, i);
+				}
+			}
 
+			if (sharedTopology != nullptr) {
+				Simulator::Destroy ();
+				delete sharedTopology;
 			}
+			runSink = 0;
+			rateSink = 0;
+			flowSink = 0;
 		}		
 	}
 	return 0;
 }
 
 
-void writeToFile(int i, int64_t delta) {
-		std::ofstream ofs;
-		ofs.open ("Final.txt", std::ofstream::out | std::ofstream::app);
+// Probability that a Student t variable with dof degrees of freedom lies
+// within [-t, t], from the finite series of Abramowitz and Stegun 26.7.3/4
+double
+studentCoverage(double t, uint32_t dof) {
+	double theta = std::atan(t / std::sqrt((double) dof));
+	double c2 = std::cos(theta) * std::cos(theta);
+	double sum = 0;
+	double term = dof % 2 ? std::cos(theta) : 1.0;
+	for (uint32_t k = dof % 2 ? 3 : 2; k <= dof; k += 2) {
+		sum += term;
+		term *= c2 * (k - 1) / k;
+	}
+	if (dof % 2) {
+		return 2 / M_PI * (theta + std::sin(theta) * sum);
+	}
+	return std::sin(theta) * sum;
+}
+
+// Student t quantile for a two-sided confidence level
+double
+studentQuantile(double confidence, uint32_t dof) {
+	dof = std::max<uint32_t>(dof, 1);
+	double lo = 0.0;
+	double hi = 1.0;
+	while (studentCoverage(hi, dof) < confidence) {
+		hi *= 2;
+	}
+	for (int k = 0; k < 64; k++) {
+		double mid = (lo + hi) / 2;
+		if (studentCoverage(mid, dof) < confidence) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return (lo + hi) / 2;
+}
+
+
+PairResult
+runPair(SimulationConfig config, bool earlyStop) {
+
+	// the low entropy run estimates the baseline dispersion, the
+	// high entropy run then stops once it can decide against it
+	Ptr<CompressionDetector> lowDetector;
+	Ptr<CompressionDetector> highDetector;
+	if (earlyStop) {
+		lowDetector = CreateObject<CompressionDetector> ();
+		highDetector = CreateObject<CompressionDetector> ();
+		highDetector->SetAttribute("Threshold", TimeValue (MilliSeconds (detectionThreshold)));
+		lowDetector->SetAttribute("ExpectedPackets", UintegerValue (config.packetCount));
+		highDetector->SetAttribute("ExpectedPackets", UintegerValue (config.packetCount));
+	}
 
-		ofs << std::to_string(i) << " "<< std::to_string(delta) <<std::endl;
+	PairResult pair;
+	config.highEntropy = false;
+	config.detector = lowDetector;
+	pair.low = makeSimulation(config);
+	recordRun(config, pair.low);
+	Time lowEDT = earlyStop ? lowDetector->GetEstimate() : pair.low.deltaTime;
 
-		ofs.close();
+	if (earlyStop) {
+		highDetector->SetReference(lowEDT);
+	}
+	config.highEntropy = true;
+	config.detector = highDetector;
+	pair.high = makeSimulation(config);
+	recordRun(config, pair.high);
+	Time highEDT = earlyStop ? highDetector->GetEstimate() : pair.high.deltaTime;
+
+	pair.delta = highEDT.GetMilliSeconds() - lowEDT.GetMilliSeconds();
+	pair.detected = earlyStop ? highDetector->IsDetected() : pair.delta >= detectionThreshold;
+	if (earlyStop) {
+		std::cout << "Early stop after " << lowDetector->GetSamples() << " low / "
+				<< highDetector->GetSamples() << " high entropy packets" << "\n";
+	}
+
+	printCodecStats(config, pair);
+	return pair;
 }
 
 
-Time
-makeSimulation(std::string pcapPrefix, std::string routersdataRate, bool compressionFlag, bool highEntropy, int round){
+void
+printCodecStats(const SimulationConfig &config, const PairResult &pair) {
+	if (config.compression && pair.low.codecBytesIn > 0) {
+		std::cout << config.codec << " low entropy bottleneck payload: " << pair.low.codecBytesIn << " -> " << pair.low.codecBytesOut
+				<< " bytes (" << 100.0 * (pair.low.codecBytesIn - pair.low.codecBytesOut) / pair.low.codecBytesIn << "% saved)\n";
+	}
+}
 
-	std::string entStr;
-	std::string drStr;	
-	if (highEntropy == true) {
-		entStr = "High Entropy";
+
+// Runs low/high pairs with independent RngRun numbers until the confidence
+// interval of the mean delta lies entirely on one side of the threshold,
+// or maxTrials pairs have been simulated.  An interval still straddling
+// the threshold then makes the decision inconclusive, neither detected nor
+// not detected.
+RateDecision
+runTrials(SimulationConfig config, bool earlyStop, uint32_t minTrials, uint32_t maxTrials, double confidence) {
+
+	RateDecision decision;
+	double mean = 0;
+	double m2 = 0;
+	uint32_t n = 0;
+	bool pairDetected = false;
+	decision.cached = true;
+	decision.lower = -std::numeric_limits<double>::infinity();
+	decision.upper = std::numeric_limits<double>::infinity();
+
+	for (uint32_t trial = 1; trial <= std::max<uint32_t>(maxTrials, 1); trial++) {
+		RngSeedManager::SetRun(trial);
+		PairResult pair;
+		if (!cachedPair(config, earlyStop, pair)) {
+			decision.cached = false;
+		}
+		pairDetected = pair.detected;
+
+		n++;
+		double d = pair.delta - mean;
+		mean += d / n;
+		m2 += d * (pair.delta - mean);
+
+		if (n >= 2) {
+			double half = studentQuantile(confidence, n - 1) * std::sqrt(m2 / (n - 1) / n);
+			decision.lower = mean - half;
+			decision.upper = mean + half;
+			if (n >= minTrials && (decision.lower >= detectionThreshold || decision.upper < detectionThreshold)) {
+				break;
+			}
+		}
+	}
+
+	decision.mean = mean;
+	decision.trials = n;
+	decision.inconclusive = n >= 2 && decision.lower < detectionThreshold && decision.upper >= detectionThreshold;
+	decision.detected = !decision.inconclusive && mean >= detectionThreshold;
+	if (n == 1) {
+		// a single pair keeps the pair's own decision (the detector's, with earlyStop)
+		decision.detected = pairDetected;
+		decision.lower = decision.upper = mean;
+	}
+	return decision;
+}
+
+
+// 64 bit FNV-1a
+uint64_t
+fnv1a(const char *data, size_t len, uint64_t hash = 0xcbf29ce484222325ULL) {
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint8_t) data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+
+// Hash of the running executable, so a rebuilt simulator never reuses
+// results produced by older code
+uint64_t
+binaryHash(void) {
+	static uint64_t hash = 0;
+	static bool done = false;
+	if (!done) {
+		std::ifstream exe("/proc/self/exe", std::ios::binary);
+		char buf[65536];
+		hash = fnv1a(nullptr, 0);
+		while (exe.read(buf, sizeof(buf)) || exe.gcount() > 0) {
+			hash = fnv1a(buf, exe.gcount(), hash);
+		}
+		done = true;
+	}
+	return hash;
+}
+
+
+// Key of one low/high pair: rate, codec, workload, seed and binary
+uint64_t
+pairKey(const SimulationConfig &config, bool earlyStop) {
+	std::ostringstream oss;
+	oss << "rate=" << rateLabel(config.dataRate)
+			<< ";compression=" << config.compression
+			<< ";codec=" << config.codec
+			<< ";level=" << config.compressionLevel
+			<< ";domain=" << config.compressionDomain
+			<< ";duplex=" << config.duplex
+			<< ";reverseSize=" << config.reverseSize
+			<< ";links=" << config.links
+			<< ";packets=" << config.packetCount
+			<< ";size=" << config.packetSize
+			<< ";interval=" << config.interval
+			<< ";burst=" << config.burst
+			<< ";flows=" << config.flows
+			<< ";flowEntropy=" << config.flowEntropy
+			<< ";flowStagger=" << config.flowStagger
+			<< ";trace=" << config.traceFile
+			<< ";traceScale=" << config.traceScale
+			<< ";entropy=" << config.entropy
+			<< ";phases=" << config.phases
+			<< ";payload=" << config.payloadFile
+			<< ";seed=" << RngSeedManager::GetSeed()
+			<< ";run=" << RngSeedManager::GetRun()
+			<< ";earlyStop=" << earlyStop
+			<< ";threshold=" << detectionThreshold
+			<< ";binary=" << std::hex << binaryHash();
+	std::string key = oss.str();
+	return fnv1a(key.data(), key.size());
+}
+
+
+std::ostream &
+operator<<(std::ostream &os, const SimulationResult &r) {
+	return os << r.deltaTime.GetTimeStep() << " " << r.codecBytesIn << " " << r.codecBytesOut
+			<< " " << r.codecPackets << " " << r.received << " " << r.lost << " " << r.reordered
+			<< " " << r.delayMean << " " << r.delayP50 << " " << r.delayP99 << " " << r.delayMax
+			<< " " << r.goodput << " " << r.fairness << " " << r.compressionLevel << " " << r.transitFrames
+			<< " " << r.reverseReceived << " " << r.reverseDelayMean << " " << r.reverseCodecBytesIn << " " << r.reverseCodecBytesOut
+			<< " " << r.lostFragments;
+}
+
+std::istream &
+operator>>(std::istream &is, SimulationResult &r) {
+	int64_t delta;
+	if (is >> delta >> r.codecBytesIn >> r.codecBytesOut >> r.codecPackets
+			>> r.received >> r.lost >> r.reordered >> r.delayMean >> r.delayP50 >> r.delayP99 >> r.delayMax
+			>> r.goodput >> r.fairness >> r.compressionLevel >> r.transitFrames
+			>> r.reverseReceived >> r.reverseDelayMean >> r.reverseCodecBytesIn >> r.reverseCodecBytesOut
+			>> r.lostFragments) {
+		r.deltaTime = TimeStep(delta);
+	}
+	return is;
+}
+
+
+// Journal lines: "key delta detected <low result> <high result>".  A line
+// cut short by a crash fails to parse and is simply simulated again.
+void
+loadResultCache(void) {
+	if (resultCacheFile.empty()) {
+		return;
+	}
+	std::ifstream ifs(resultCacheFile);
+	std::string line;
+	while (std::getline(ifs, line)) {
+		std::istringstream iss(line);
+		uint64_t key;
+		PairResult pair;
+		if (iss >> std::hex >> key >> std::dec >> pair.delta >> pair.detected >> pair.low >> pair.high) {
+			resultCache[key] = pair;
+		}
+	}
+	if (!resultCache.empty()) {
+		std::cout << resultCache.size() << " cached runs in " << resultCacheFile << std::endl;
+	}
+}
+
+
+// Returns the pair from the cache, or simulates and journals it.
+// Returns true if the pair was found in the cache.
+bool
+cachedPair(const SimulationConfig &config, bool earlyStop, PairResult &pair) {
+	if (resultCacheFile.empty()) {
+		pair = runPair(config, earlyStop);
+		return false;
+	}
+	uint64_t key = pairKey(config, earlyStop);
+	if (lookupPair(key, pair)) {
+		return true;
+	}
+	pair = runPair(config, earlyStop);
+	storePair(key, pair);
+	return false;
+}
+
+
+bool
+lookupPair(uint64_t key, PairResult &pair) {
+	std::map<uint64_t, PairResult>::const_iterator it = resultCache.find(key);
+	if (resultCacheFile.empty() || it == resultCache.end()) {
+		return false;
+	}
+	pair = it->second;
+	return true;
+}
+
+
+void
+storePair(uint64_t key, const PairResult &pair) {
+	if (resultCacheFile.empty()) {
+		return;
+	}
+	resultCache[key] = pair;
+
+	// the pair's Runs.csv rows reach the file before the journal skips the pair
+	runSink->Flush();
+	std::ofstream ofs(resultCacheFile, std::ofstream::out | std::ofstream::app);
+	ofs << std::hex << std::setw(16) << std::setfill('0') << key << std::dec
+			<< " " << pair.delta << " " << pair.detected << " " << pair.low << " " << pair.high << std::endl;
+}
+
+
+// Whether runs at this rate are captured, --pcapRates lists rates as in file names
+bool
+captureRate(const SweepOptions &options, double rate) {
+	if (options.pcapRates.empty()) {
+		return true;
+	}
+	std::istringstream iss(options.pcapRates);
+	std::string item;
+	while (std::getline(iss, item, ',')) {
+		if (item == rateLabel(rate)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// Whether device i of a topology (ndc01, ndc12, ndc23 ends in order) is captured
+bool
+captureDevice(const std::string &devices, uint32_t i) {
+	if (devices == "all") {
+		return true;
+	}
+	if (devices == "ndc12") {
+		return i == 2 || i == 3;
+	}
+	std::istringstream iss(devices);
+	std::string item;
+	while (std::getline(iss, item, ',')) {
+		if (item == std::to_string(i)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// Rate in Mbps as used in file names: "3" or "2.75"
+std::string
+rateLabel(double rate) {
+	std::ostringstream oss;
+	oss << rate;
+	return oss.str();
+}
+
+
+// Runs the trials for one data rate, records and prints the decision
+RateDecision
+evaluateRate(const SweepOptions &options, double rate) {
+
+	SimulationConfig config = options.base;
+	config.dataRate = rate;
+	config.pcap.enabled = captureRate(options, rate);
+
+	RateDecision decision = runTrials(config, options.earlyStop, options.minTrials, options.maxTrials, options.confidence);
+	reportRate(options, rate, decision);
+	return decision;
+}
+
+
+// Records a rate decision in Rates.csv and prints it
+void
+reportRate(const SweepOptions &options, double rate, const RateDecision &decision) {
+	if (decision.cached) {
+		std::cout << "Reusing cached result" << "\n";
+	}
+	// written even when cached: the run that simulated it may have died
+	// before its row left the sink's buffer
+	recordRate(options.base, rate, decision);
+	runSink->Flush();
+	rateSink->Flush();
+
+	if (decision.trials > 1) {
+		std::cout << decision.trials << " trials, delta " << decision.mean << " ms in ["
+				<< decision.lower << ", " << decision.upper << "] at " << 100 * options.confidence << "% confidence\n";
+	}
+	if (decision.inconclusive) {
+		std::cout << "Inconclusive at datarate "<< rateLabel(rate)<<" Mbps after "<< decision.trials <<" trials, delta time is "<< decision.mean <<" ms"<< "\n\n";
+	} else if (decision.detected) {
+		std::cout << "Compression detected at datarate "<< rateLabel(rate)<<" Mbps, coz delta time is "<< decision.mean <<" ms"<< "\n\n";
 	} else {
-		entStr = "Low Entropy";
+		std::cout << "Not detected at datarate "<< rateLabel(rate)<<" Mbps, coz delta time is "<< decision.mean <<" ms"<< "\n\n";
 	}
+}
 
 
-	std::cout<<"Simulation - "<<"\tData Rate : "<<std::to_string(round)<< "\t"<<entStr<<"\n";
+// Linear sweep with the low and high entropy runs of several rates built
+// side by side in one Simulator run, batch experiments at a time.  The
+// copies share nothing but the event loop, so each server still measures
+// its own flow only.
+void
+sweepBatched(const SweepOptions &options, int minRate, int maxRate) {
+
+	std::vector<SimulationConfig> configs;
+	std::vector<uint64_t> keys;
+	std::map<int, PairResult> pairs;
+	std::set<int> cachedRates;
+
+	for (int i = minRate; i <= maxRate; i++) {
+		SimulationConfig config = options.base;
+		config.dataRate = i;
+		config.pcap.enabled = captureRate(options, i);
+		RngSeedManager::SetRun(1);
+		uint64_t key = pairKey(config, false);
+		PairResult pair;
+		if (lookupPair(key, pair)) {
+			pairs[i] = pair;
+			cachedRates.insert(i);
+			continue;
+		}
+		config.highEntropy = false;
+		configs.push_back(config);
+		config.highEntropy = true;
+		configs.push_back(config);
+		keys.push_back(key);
+	}
+
+	// an odd batch would split a pair across two runs
+	uint32_t perRun = std::max<uint32_t>(options.batch / 2, 1) * 2;
+	for (size_t first = 0; first < configs.size(); first += perRun) {
+		size_t last = std::min(configs.size(), first + perRun);
+		std::vector<SimulationConfig> chunk(configs.begin() + first, configs.begin() + last);
+		std::vector<SimulationResult> results = makeBatch(chunk);
+		for (size_t j = 0; j < results.size(); j += 2) {
+			const SimulationConfig &config = chunk[j];
+			PairResult pair;
+			pair.low = results[j];
+			pair.high = results[j + 1];
+			recordRun(chunk[j], pair.low);
+			recordRun(chunk[j + 1], pair.high);
+			pair.delta = pair.high.deltaTime.GetMilliSeconds() - pair.low.deltaTime.GetMilliSeconds();
+			pair.detected = pair.delta >= detectionThreshold;
+			printCodecStats(config, pair);
+			storePair(keys[(first + j) / 2], pair);
+			pairs[(int) config.dataRate] = pair;
+		}
+	}
+
+	for (int i = minRate; i <= maxRate; i++) {
+		const PairResult &pair = pairs[i];
+		RateDecision decision;
+		decision.mean = decision.lower = decision.upper = pair.delta;
+		decision.trials = 1;
+		decision.detected = pair.detected;
+		decision.inconclusive = false;
+		decision.cached = cachedRates.count(i) > 0;
+		reportRate(options, i, decision);
+	}
+}
+
+
+// Bisection for the highest rate at which compression is still detected.
+// A slower bottleneck makes compression more visible, so detection is
+// assumed to hold below the crossover and fail above it.  An inconclusive
+// rate cannot be placed on either side, so the search stops there.
+void
+searchThreshold(const SweepOptions &options, double minRate, double maxRate, double resolution) {
+
+	RateDecision decision = evaluateRate(options, minRate);
+	if (decision.inconclusive) {
+		std::cout << "Search stopped, " << rateLabel(minRate) << " Mbps is inconclusive (raise --maxTrials)" << "\n\n";
+		return;
+	}
+	if (!decision.detected) {
+		std::cout << "Compression not detectable even at " << rateLabel(minRate) << " Mbps" << "\n\n";
+		return;
+	}
+	decision = evaluateRate(options, maxRate);
+	if (decision.inconclusive) {
+		std::cout << "Search stopped, " << rateLabel(maxRate) << " Mbps is inconclusive (raise --maxTrials)" << "\n\n";
+		return;
+	}
+	if (decision.detected) {
+		std::cout << "Compression still detected at " << rateLabel(maxRate) << " Mbps, crossover is above the range" << "\n\n";
+		return;
+	}
+
+	double lo = minRate;   // detected
+	double hi = maxRate;   // not detected
+	uint32_t points = 2;
+	while (hi - lo > resolution) {
+		double mid = (lo + hi) / 2;
+		decision = evaluateRate(options, mid);
+		points++;
+		if (decision.inconclusive) {
+			std::cout << "Search stopped, " << rateLabel(mid) << " Mbps is inconclusive (raise --maxTrials); crossover between "
+					<< rateLabel(lo) << " and " << rateLabel(hi) << " Mbps (" << points << " rates evaluated)" << "\n\n";
+			return;
+		}
+		if (decision.detected) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	std::cout << "Detection crossover between " << rateLabel(lo) << " and " << rateLabel(hi)
+			<< " Mbps (" << points << " rates evaluated)" << "\n\n";
+}
+
+
+void
+openResults(bool binary) {
+	std::vector<ResultsSink::Column> runs = {
+		{"rate_mbps", ResultsSink::REAL}, {"compression", ResultsSink::INTEGER},
+		{"codec", ResultsSink::TEXT}, {"entropy", ResultsSink::TEXT},
+		{"entropy_bits", ResultsSink::REAL}, {"phases", ResultsSink::TEXT},
+		{"seed", ResultsSink::INTEGER}, {"run", ResultsSink::INTEGER},
+		{"packets", ResultsSink::INTEGER}, {"packet_size", ResultsSink::INTEGER},
+		{"interval_us", ResultsSink::REAL}, {"received", ResultsSink::INTEGER},
+		{"lost", ResultsSink::INTEGER}, {"reordered", ResultsSink::INTEGER},
+		{"delta_ns", ResultsSink::INTEGER},
+		{"delay_mean_us", ResultsSink::REAL}, {"delay_p50_us", ResultsSink::REAL},
+		{"delay_p99_us", ResultsSink::REAL}, {"delay_max_us", ResultsSink::REAL},
+		{"flows", ResultsSink::INTEGER}, {"goodput_mbps", ResultsSink::REAL},
+		{"fairness", ResultsSink::REAL}, {"codec_bytes_in", ResultsSink::INTEGER}, {"codec_bytes_out", ResultsSink::INTEGER},
+		{"codec_packets", ResultsSink::INTEGER},
+		{"compression_level", ResultsSink::INTEGER}, {"final_level", ResultsSink::INTEGER},
+		{"domain", ResultsSink::TEXT}, {"transit_frames", ResultsSink::INTEGER},
+		{"duplex", ResultsSink::INTEGER}, {"reverse_received", ResultsSink::INTEGER},
+		{"reverse_delay_mean_us", ResultsSink::REAL}, {"reverse_codec_bytes_in", ResultsSink::INTEGER},
+		{"reverse_codec_bytes_out", ResultsSink::INTEGER},
+		{"links", ResultsSink::INTEGER}, {"lost_fragments", ResultsSink::INTEGER}};
+	std::vector<ResultsSink::Column> rates = {
+		{"rate_mbps", ResultsSink::REAL}, {"compression", ResultsSink::INTEGER},
+		{"codec", ResultsSink::TEXT}, {"packets", ResultsSink::INTEGER},
+		{"packet_size", ResultsSink::INTEGER}, {"trials", ResultsSink::INTEGER},
+		{"delta_ms", ResultsSink::REAL}, {"lower_ms", ResultsSink::REAL},
+		{"upper_ms", ResultsSink::REAL}, {"detected", ResultsSink::INTEGER},
+		{"inconclusive", ResultsSink::INTEGER}};
+	runSink = Create<ResultsSink> ("Runs.csv", runs, binary ? "Runs.col" : "");
+	rateSink = Create<ResultsSink> ("Rates.csv", rates, binary ? "Rates.col" : "");
+}
+
+
+void
+recordRun(const SimulationConfig &config, const SimulationResult &result) {
+	ResultsSink::Record r = runSink->NewRecord();
+	r.Set("rate_mbps", config.dataRate)
+			.Set("compression", (int64_t) config.compression)
+			.Set("codec", config.codec)
+			.Set("entropy", std::string(config.highEntropy ? "high" : "low"))
+			.Set("entropy_bits", config.highEntropy ? config.entropy : 0.0)
+			.Set("phases", config.highEntropy ? config.phases : std::string())
+			.Set("seed", (int64_t) RngSeedManager::GetSeed())
+			.Set("run", (int64_t) RngSeedManager::GetRun())
+			.Set("packets", (int64_t) config.packetCount)
+			.Set("packet_size", (int64_t) config.packetSize)
+			.Set("interval_us", config.interval)
+			.Set("received", (int64_t) result.received)
+			.Set("lost", (int64_t) result.lost)
+			.Set("reordered", (int64_t) result.reordered)
+			.Set("delta_ns", result.deltaTime.GetNanoSeconds())
+			.Set("delay_mean_us", result.delayMean)
+			.Set("delay_p50_us", result.delayP50)
+			.Set("delay_p99_us", result.delayP99)
+			.Set("delay_max_us", result.delayMax)
+			.Set("flows", (int64_t) config.flows)
+			.Set("goodput_mbps", result.goodput)
+			.Set("fairness", result.fairness)
+			.Set("codec_bytes_in", (int64_t) result.codecBytesIn)
+			.Set("codec_bytes_out", (int64_t) result.codecBytesOut)
+			.Set("codec_packets", (int64_t) result.codecPackets)
+			.Set("compression_level", (int64_t) config.compressionLevel)
+			.Set("final_level", (int64_t) result.compressionLevel)
+			.Set("domain", config.compressionDomain)
+			.Set("transit_frames", (int64_t) result.transitFrames)
+			.Set("duplex", (int64_t) config.duplex)
+			.Set("reverse_received", (int64_t) result.reverseReceived)
+			.Set("reverse_delay_mean_us", result.reverseDelayMean)
+			.Set("reverse_codec_bytes_in", (int64_t) result.reverseCodecBytesIn)
+			.Set("reverse_codec_bytes_out", (int64_t) result.reverseCodecBytesOut)
+			.Set("links", (int64_t) config.links)
+			.Set("lost_fragments", (int64_t) result.lostFragments);
+	runSink->Write(r);
+
+	if (result.flows.empty()) {
+		return;
+	}
+	if (!flowSink) {
+		std::vector<ResultsSink::Column> flows = {
+			{"rate_mbps", ResultsSink::REAL}, {"compression", ResultsSink::INTEGER},
+			{"codec", ResultsSink::TEXT}, {"run", ResultsSink::INTEGER},
+			{"flows", ResultsSink::INTEGER}, {"flow", ResultsSink::INTEGER},
+			{"entropy", ResultsSink::TEXT}, {"received", ResultsSink::INTEGER},
+			{"lost", ResultsSink::INTEGER}, {"throughput_mbps", ResultsSink::REAL},
+			{"delay_mean_us", ResultsSink::REAL}};
+		flowSink = Create<ResultsSink> ("Flows.csv", flows, resultsBinary ? "Flows.col" : "");
+	}
+	for (size_t k = 0; k < result.flows.size(); k++) {
+		const FlowResult &flow = result.flows[k];
+		ResultsSink::Record f = flowSink->NewRecord();
+		f.Set("rate_mbps", config.dataRate)
+				.Set("compression", (int64_t) config.compression)
+				.Set("codec", config.codec)
+				.Set("run", (int64_t) RngSeedManager::GetRun())
+				.Set("flows", (int64_t) config.flows)
+				.Set("flow", (int64_t) flow.flow)
+				.Set("entropy", std::string(flow.highEntropy ? "high" : "low"))
+				.Set("received", (int64_t) flow.received)
+				.Set("lost", (int64_t) flow.lost)
+				.Set("throughput_mbps", flow.throughput)
+				.Set("delay_mean_us", flow.delayMean);
+		flowSink->Write(f);
+	}
+}
+
+
+// A single pair gives equal bounds, its decision is the pair's own
+void
+recordRate(const SimulationConfig &config, double rate, const RateDecision &decision) {
+	ResultsSink::Record r = rateSink->NewRecord();
+	r.Set("rate_mbps", rate)
+			.Set("compression", (int64_t) config.compression)
+			.Set("codec", config.codec)
+			.Set("packets", (int64_t) config.packetCount)
+			.Set("packet_size", (int64_t) config.packetSize)
+			.Set("trials", (int64_t) decision.trials)
+			.Set("delta_ms", decision.mean)
+			.Set("lower_ms", decision.lower)
+			.Set("upper_ms", decision.upper)
+			.Set("detected", (int64_t) decision.detected)
+			.Set("inconclusive", (int64_t) decision.inconclusive);
+	rateSink->Write(r);
+}
+
+
+SimulationResult
+makeSimulation(const SimulationConfig &config){
+	if (!reuseTopology) {
+		return makeBatch(std::vector<SimulationConfig> (1, config))[0];
+	}
+
+	// Only node, stack and route construction is saved.  Simulation time
+	// cannot be rewound without destroying the nodes, so each experiment
+	// starts where the previous one ended, and every Run goes on to its
+	// applications' stop 40000 s later (nothing happens in between, so it
+	// costs no wall-clock time).  The applications of earlier experiments
+	// stay on the nodes, stopped, with their sockets bound; results and
+	// pcap timestamps only depend on times relative to each start.
+	if (sharedTopology == nullptr) {
+		sharedTopology = new Topology (buildTopology(0, config.links));
+		Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+	}
+	Experiment experiment = installExperiment(*sharedTopology, config);
+	Simulator::Run();
+	return collectResult(experiment);
+}
+
+
+// Builds every experiment, runs them in a single event loop and returns
+// their results in the order of configs
+std::vector<SimulationResult>
+makeBatch(const std::vector<SimulationConfig> &configs){
+
+	NS_ABORT_MSG_IF (configs.size() > 250 * 250, "too many experiments in one batch");
+
+	std::vector<Experiment> experiments;
+	for (uint32_t k = 0; k < configs.size(); k++) {
+		experiments.push_back(buildExperiment(configs[k], k));
+	}
+
+	// Create router nodes, initialize routing database and set up the routing
+	// tables in the nodes.
+	Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+	//start and then destroy simulator
+	Simulator::Run();
+
+	std::vector<SimulationResult> results;
+	for (uint32_t k = 0; k < experiments.size(); k++) {
+		results.push_back(collectResult(experiments[k]));
+	}
+
+	Simulator::Destroy ();
+
+	return results;
+}
+
+
+SimulationResult
+collectResult(const Experiment &experiment){
+	SimulationResult result;
+	result.deltaTime = experiment.server->deltaTime;
+	result.codecBytesIn = experiment.encoder->GetCodecBytesIn();
+	result.codecBytesOut = experiment.encoder->GetCodecBytesOut();
+	result.codecPackets = experiment.encoder->GetCodecPackets() + experiment.decoder->GetCodecPackets();
+	result.compressionLevel = experiment.encoder->GetCompression() ? experiment.encoder->GetCompressionLevel() : 0;
+	result.transitFrames = 0;
+	for (uint32_t i = 0; i < experiment.transit.size(); i++) {
+		result.transitFrames += experiment.transit[i]->GetTransitFrames();
+	}
+	PointToPointNetDevice::CodecStats reverse = experiment.decoder->GetCodecStats(PointToPointNetDevice::EGRESS);
+	result.reverseCodecBytesIn = reverse.bytesIn;
+	result.reverseCodecBytesOut = reverse.bytesOut;
+	result.lostFragments = 0;
+	if (experiment.bundle1) {
+		// the bundle ends run the codec, their members only carry fragments
+		PointToPointNetDevice::CodecStats forward = experiment.bundle1->GetCodecStats(PointToPointNetDevice::EGRESS);
+		result.codecBytesIn = forward.bytesIn;
+		result.codecBytesOut = forward.bytesOut;
+		result.codecPackets = experiment.bundle1->GetCodecPackets() + experiment.bundle2->GetCodecPackets();
+		result.compressionLevel = experiment.bundle1->GetCompressionLevel();
+		reverse = experiment.bundle2->GetCodecStats(PointToPointNetDevice::EGRESS);
+		result.reverseCodecBytesIn = reverse.bytesIn;
+		result.reverseCodecBytesOut = reverse.bytesOut;
+		result.lostFragments = experiment.bundle1->GetLostFragments() + experiment.bundle2->GetLostFragments();
+	}
+	result.reverseReceived = 0;
+	result.reverseDelayMean = 0;
+	if (experiment.reverseServer) {
+		const HdrHistogram &reverseDelay = experiment.reverseServer->GetDelayHistogram();
+		result.reverseReceived = reverseDelay.GetCount();
+		result.reverseDelayMean = reverseDelay.GetMean() / 1000;
+	}
+	const HdrHistogram &delay = experiment.server->GetDelayHistogram();
+	result.received = delay.GetCount();
+	result.lost = experiment.server->GetLost();
+	result.reordered = experiment.server->GetReordered();
+
+	// goodput and fairness over every flow; a server may see several sources
+	Time first = Time::Max();
+	Time last = Time (0);
+	uint64_t bytes = 0;
+	double sum = 0;
+	double squares = 0;
+	uint32_t n = 0;
+	for (size_t k = 0; k < experiment.servers.size(); k++) {
+		const UdpServer::FlowMap &flows = experiment.servers[k]->GetFlows();
+		for (UdpServer::FlowMap::const_iterator it = flows.begin(); it != flows.end(); ++it) {
+			const UdpServer::FlowStats &stats = it->second;
+			Time span = stats.lastArrival - stats.firstArrival;
+			FlowResult flow;
+			flow.flow = k;
+			flow.highEntropy = experiment.highEntropy[k];
+			flow.received = stats.received;
+			flow.lost = stats.sequence.GetLost();
+			flow.throughput = span.IsPositive() ? stats.bytes * 8 / span.GetSeconds() / 1e6 : 0;
+			flow.delayMean = stats.delaySum.GetMicroSeconds() / (double) stats.received;
+			first = std::min(first, stats.firstArrival);
+			last = std::max(last, stats.lastArrival);
+			bytes += stats.bytes;
+			sum += flow.throughput;
+			squares += flow.throughput * flow.throughput;
+			n++;
+			if (experiment.servers.size() > 1) {
+				result.flows.push_back(flow);
+			}
+		}
+	}
+	result.goodput = last > first ? bytes * 8 / (last - first).GetSeconds() / 1e6 : 0;
+	result.fairness = squares > 0 ? sum * sum / (n * squares) : 1;
+	result.delayMean = delay.GetMean() / 1000;
+	result.delayP50 = delay.GetPercentile(0.5) / 1000.0;
+	result.delayP99 = delay.GetPercentile(0.99) / 1000.0;
+	result.delayMax = delay.GetMax() / 1000.0;
+	experiment.ppp1->DisableQueueSampler();
+
+	// dropping the writers flushes and closes the files
+	for (size_t i = 0; i < experiment.pcap.size(); i++) {
+		experiment.pcap[i]->file = 0;
+	}
+	return result;
+}
+
+
+// Builds the 4 node topology and applications of one experiment.  The
+// index selects a private 10.x.y.0 subnet so copies sharing a run never
+// route into each other.
+Experiment
+buildExperiment(const SimulationConfig &config, uint32_t index){
+	Topology topology = buildTopology(index, config.links);
+	return installExperiment(topology, config);
+}
+
+
+// Writes a device's frames to the pcap file of the experiment currently
+// running on the topology, with timestamps relative to its start.  The
+// writer only buffers the record, a background thread does the disk I/O.
+void
+pcapSink(Ptr<PcapTarget> target, Ptr<const Packet> p) {
+	if (target->file && target->seen++ % target->sample == 0) {
+		target->file->Write(Simulator::Now() - target->origin, p);
+	}
+}
+
+
+Topology
+buildTopology(uint32_t index, uint32_t links){
 
 	//LogComponentEnable ("PointToPointNetDevice", LOG_LEVEL_INFO);
 	//LogComponentEnable ("UdpClient", LOG_LEVEL_INFO);
 	//LogComponentEnable ("UdpServer", LOG_LEVEL_INFO);
 	//idlilate
-	Config::SetDefault("ns3::QueueBase::MaxSize",StringValue("6000p"));
+	//queue size set in main from the flow length
 	//Packet::EnablePrinting();
 
+	Topology topology;
+
 	//creating 4 nodes
 	NodeContainer nodes;
 	nodes.Create(4);
@@ -164,6 +1268,7 @@ makeSimulation(std::string pcapPrefix, std::string routersdataRate, bool compres
 
 	//creating pointtopoint helper - net device and channel
 	//real world corresponds to ethernet card and network cables
+	//ndc12 gets its data rate from each experiment
 	PointToPointHelper pointToPoint;
 
 	pointToPoint.SetDeviceAttribute("DataRate", StringValue ("8Mbps"));
@@ -171,34 +1276,29 @@ makeSimulation(std::string pcapPrefix, std::string routersdataRate, bool compres
 
 	//create netDeviceContainer - makes use of pointtopoint helper
 	NetDeviceContainer ndc01 = pointToPoint.Install (nodes.Get (0), nodes.Get (1));
-
-	pointToPoint.SetDeviceAttribute("DataRate", StringValue (routersdataRate));
-	pointToPoint.SetChannelAttribute("Delay", StringValue ("0ms"));
-
-	NetDeviceContainer ndc12 = pointToPoint.Install (nodes.Get (1), nodes.Get (2));
-
-	pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
-	pointToPoint.SetChannelAttribute ("Delay", StringValue ("0ms"));
-
+	NetDeviceContainer ndc12;
+	if (links > 1) {
+		ndc12 = installBundle(nodes.Get (1), nodes.Get (2), links);
+	} else {
+		ndc12 = pointToPoint.Install (nodes.Get (1), nodes.Get (2));
+	}
 	NetDeviceContainer ndc23 = pointToPoint.Install (nodes.Get (2), nodes.Get (3));
 
-	Ptr<PointToPointNetDevice> ppp1 = DynamicCast<PointToPointNetDevice>(ndc12.Get (0));
-
-	Ptr<PointToPointNetDevice> ppp2 = DynamicCast<PointToPointNetDevice> (ndc12.Get (1));
-
-	std::string isComp;
-	if(compressionFlag == true) {
-		ppp1->EnableCompression();	
-		ppp2->EnableDecompression();
-		isComp = "CY";
+	topology.bundle1 = DynamicCast<MultilinkPppNetDevice>(ndc12.Get (0));
+	topology.bundle2 = DynamicCast<MultilinkPppNetDevice>(ndc12.Get (1));
+	if (topology.bundle1) {
+		topology.ppp1 = topology.bundle1->GetMember (0);
+		topology.ppp2 = topology.bundle2->GetMember (0);
 	} else {
-		isComp = "CN";
+		topology.ppp1 = DynamicCast<PointToPointNetDevice>(ndc12.Get (0));
+		topology.ppp2 = DynamicCast<PointToPointNetDevice> (ndc12.Get (1));
 	}
 
 
 	//use ipv4addresshelper for allocation of ip address
 	Ipv4AddressHelper address;
-	address.SetBase("10.1.1.0", "255.255.255.0");
+	std::string subnet = "10." + std::to_string(1 + index / 250) + "." + std::to_string(1 + index % 250) + ".0";
+	address.SetBase(subnet.c_str(), "255.255.255.0");
 
 
 	//use ipv4interfacecontainer to associate netdevice and ipaddress
@@ -206,9 +1306,163 @@ makeSimulation(std::string pcapPrefix, std::string routersdataRate, bool compres
 	Ipv4InterfaceContainer ifc12 = address.Assign(ndc12);
 	Ipv4InterfaceContainer ifc23 = address.Assign(ndc23);
 
-	// Create router nodes, initialize routing database and set up the routing
-	// tables in the nodes.
-	Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+	// routing tables are populated once every copy is built
+
+	topology.nodes = nodes;
+	topology.devices.Add(ndc01);
+	topology.devices.Add(ndc12);
+	topology.devices.Add(ndc23);
+	topology.serverAddress = ifc23.GetAddress(1);
+	topology.clientAddress = ifc01.GetAddress(0);
+	topology.nextPort = 9;
+
+	for (uint32_t i = 0; i < topology.devices.GetN(); i++) {
+		Ptr<PcapTarget> target = Create<PcapTarget> ();
+		topology.devices.Get(i)->TraceConnectWithoutContext("PromiscSniffer", MakeBoundCallback(&pcapSink, target));
+		topology.pcap.push_back(target);
+	}
+
+	return topology;
+}
+
+
+// Connects two nodes with a Multilink PPP bundle of links parallel
+// point-to-point links.  The members are not added to the nodes: only the
+// bundle ends get addresses and routes, the members carry its fragments.
+NetDeviceContainer
+installBundle(Ptr<Node> a, Ptr<Node> b, uint32_t links) {
+	Ptr<MultilinkPppNetDevice> bundleA = CreateObject<MultilinkPppNetDevice> ();
+	Ptr<MultilinkPppNetDevice> bundleB = CreateObject<MultilinkPppNetDevice> ();
+	bundleA->SetAddress(Mac48Address::Allocate ());
+	bundleB->SetAddress(Mac48Address::Allocate ());
+	for (uint32_t i = 0; i < links; i++) {
+		Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+		Ptr<PointToPointNetDevice> memberA = CreateObject<PointToPointNetDevice> ();
+		Ptr<PointToPointNetDevice> memberB = CreateObject<PointToPointNetDevice> ();
+		memberA->SetAddress(Mac48Address::Allocate ());
+		memberB->SetAddress(Mac48Address::Allocate ());
+		memberA->SetQueue(CreateObject<DropTailQueue<Packet> > ());
+		memberB->SetQueue(CreateObject<DropTailQueue<Packet> > ());
+		memberA->Attach(channel);
+		memberB->Attach(channel);
+		bundleA->AddMember(memberA);
+		bundleB->AddMember(memberB);
+	}
+	a->AddDevice(bundleA);
+	b->AddDevice(bundleB);
+	Ptr<MultilinkPppChannel> channel = CreateObject<MultilinkPppChannel> ();
+	bundleA->Attach(channel);
+	bundleB->Attach(channel);
+
+	NetDeviceContainer devices;
+	devices.Add(bundleA);
+	devices.Add(bundleB);
+	return devices;
+}
+
+
+// Configures the bottleneck codec and installs the client and server of
+// one experiment on a built topology.  Applications start relative to the
+// current simulation time, so a topology can host experiments one after
+// the other.
+Experiment
+installExperiment(Topology &topology, const SimulationConfig &config){
+
+	std::string pcapPrefix = config.pcapPrefix;
+	DataRate routersdataRate (static_cast<uint64_t> (config.dataRate * 1e6));
+	bool compressionFlag = config.compression;
+	bool highEntropy = config.highEntropy;
+	std::string round = rateLabel(config.dataRate);
+	std::string codec = config.codec;
+	uint32_t compressionThreads = config.compressionThreads;
+
+	std::string entStr;
+	std::string drStr;	
+	if (highEntropy == true) {
+		entStr = "High Entropy";
+	} else {
+		entStr = "Low Entropy";
+	}
+
+
+	std::cout<<"Simulation - "<<"\tData Rate : "<<round<< "\t"<<entStr<<"\n";
+
+	Ptr<PointToPointNetDevice> ppp1 = topology.ppp1;
+	Ptr<PointToPointNetDevice> ppp2 = topology.ppp2;
+
+	// a path domain may have left codec settings on any device
+	std::vector<Ptr<PointToPointNetDevice> > path;
+	for (uint32_t i = 0; i < topology.devices.GetN(); i++) {
+		Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice>(topology.devices.Get(i));
+		if (device) {
+			device->ResetCodec();
+			path.push_back(device);
+		}
+	}
+	ppp1->SetDataRate(routersdataRate);
+	ppp2->SetDataRate(routersdataRate);
+	if (topology.bundle1) {
+		// every member runs at the data rate, the bundle at links times it
+		topology.bundle1->ResetCodec();
+		topology.bundle2->ResetCodec();
+		for (uint32_t i = 0; i < topology.bundle1->GetNMembers(); i++) {
+			topology.bundle1->GetMember(i)->SetDataRate(routersdataRate);
+			topology.bundle2->GetMember(i)->SetDataRate(routersdataRate);
+		}
+	}
+
+	// ends of the compression domain: ndc12 itself, or the client's egress
+	// and the server's ingress with routers forwarding compressed frames
+	Experiment experiment;
+	experiment.encoder = ppp1;
+	experiment.decoder = ppp2;
+
+	std::string isComp;
+	if(compressionFlag == true && codec == "re") {
+		ppp1->EnableRedundancyElimination();
+		ppp2->EnableRedundancyRestoration();
+		if (config.duplex) {
+			ppp2->EnableRedundancyElimination();
+			ppp1->EnableRedundancyRestoration();
+		}
+		isComp = "RE";
+	} else if(compressionFlag == true && topology.bundle1) {
+		topology.bundle1->EnableCompression();
+		topology.bundle2->EnableDecompression();
+		if (config.duplex) {
+			topology.bundle2->EnableCompression();
+			topology.bundle1->EnableDecompression();
+		}
+		topology.bundle1->SetAttribute("CompressionLevel", UintegerValue (config.compressionLevel));
+		topology.bundle2->SetAttribute("CompressionLevel", UintegerValue (config.compressionLevel));
+		isComp = "CY";
+	} else if(compressionFlag == true) {
+		if (config.compressionDomain == "path") {
+			experiment.encoder = path.front();
+			experiment.decoder = path.back();
+			experiment.transit.assign(path.begin() + 1, path.end() - 1);
+			for (uint32_t i = 0; i < experiment.transit.size(); i++) {
+				experiment.transit[i]->EnableCompressedTransit();
+			}
+		}
+		std::vector<Ptr<PointToPointNetDevice> > encoders (1, experiment.encoder);
+		experiment.encoder->EnableCompression();	
+		experiment.decoder->EnableDecompression();
+		if (config.duplex) {
+			// each end deflates what it sends and inflates what it receives
+			experiment.encoder->EnableBidirectionalCompression();
+			experiment.decoder->EnableBidirectionalCompression();
+			encoders.push_back(experiment.decoder);
+		}
+		for (uint32_t i = 0; i < encoders.size(); i++) {
+			encoders[i]->SetAttribute("CompressionThreads", UintegerValue (compressionThreads));
+			encoders[i]->SetAttribute("AdaptiveCompression", BooleanValue (config.compressionLevel < 0));
+			encoders[i]->SetAttribute("CompressionLevel", UintegerValue (config.compressionLevel < 0 ? 9 : config.compressionLevel));
+		}
+		isComp = "CY";
+	} else {
+		isComp = "CN";
+	}
 
 	//// now at this point we have network built,
 	////  at this point now we need applications to generate traffic
@@ -217,48 +1471,130 @@ makeSimulation(std::string pcapPrefix, std::string routersdataRate, bool compres
 	NS_LOG_INFO ("Creating Application 1");
 
 	//
-	// Create one udpServer applications on node one.
+	// Create one udpServer and one udpClient per flow.
+	// Servers of earlier experiments keep their socket bound, hence a new port.
+	// Flow k starts k * flowStagger after flow 0; flow 0 has the run's
+	// entropy and is the one measured.
 	//
-	uint16_t port = 9;
-	UdpServerHelper server (port);
-	ApplicationContainer serverApps = server.Install (nodes.Get (3));
-
-	serverApps.Start (Seconds (1.0));
-	serverApps.Stop (Seconds (40000.0));
-
-	uint32_t MaxPacketSize = 1150;//5+7; //config file
-	Time interPacketInterval = Seconds (0.00);
-	uint32_t maxPacketCount = 6000; //config file
-	UdpClientHelper client (ifc23.GetAddress(1), port);
-
-	client.SetAttribute ("MaxPackets", UintegerValue (maxPacketCount));
-	client.SetAttribute ("Interval", TimeValue (interPacketInterval));
-	client.SetAttribute ("PacketSize", UintegerValue (MaxPacketSize));
-	
+	std::string isHigh = highEntropy ? "h" : "l";
+	uint32_t flows = std::max<uint32_t>(config.flows, 1);
+	// unpaced packets all leave at the same time, one event can send them
+	uint32_t burst = config.burst > 0 ? config.burst : (config.interval > 0 ? 1 : config.packetCount);
+	for (uint32_t k = 0; k < flows; k++) {
+		NS_ABORT_MSG_IF (topology.nextPort == 0, "--reuseTopology ran out of server ports, sweep fewer points per run");
+		uint16_t port = topology.nextPort++;
+		UdpServerHelper server (port);
+		server.SetAttribute ("FlowStats", BooleanValue (true));
+		ApplicationContainer serverApps = server.Install (topology.nodes.Get (3));
+
+		serverApps.Start (Seconds (1.0));
+		serverApps.Stop (Seconds (40000.0));
+
+		if (k == 0 && config.detector) {
+			server.GetServer()->TraceConnectWithoutContext("Rx", MakeCallback(&CompressionDetector::NotifyRx, config.detector));
+		}
+		if (k == 0 && config.statsFiles) {
+			server.GetServer()->SetAttribute("StatsFile", StringValue ("stats_"+isComp+"_dr_"+round+"_ent_"+isHigh+".txt"));
+		}
+
+		uint32_t MaxPacketSize = config.packetSize;
+		Time interPacketInterval = NanoSeconds (static_cast<int64_t> (config.interval * 1000));
+		uint32_t maxPacketCount = config.packetCount;
+		UdpClientHelper client (topology.serverAddress, port);
+
+		client.SetAttribute ("MaxPackets", UintegerValue (maxPacketCount));
+		client.SetAttribute ("Interval", TimeValue (interPacketInterval));
+		client.SetAttribute ("BurstSize", UintegerValue (std::max<uint32_t>(burst, 1)));
+		client.SetAttribute ("PacketSize", UintegerValue (MaxPacketSize));
+		client.SetAttribute ("PayloadFile", StringValue (config.payloadFile));
+		client.SetAttribute ("LatencyTag", BooleanValue (config.latencyTag));
+		client.SetAttribute ("TraceFile", StringValue (config.traceFile));
+		client.SetAttribute ("TraceTimeScale", DoubleValue (config.traceScale));
+
+		bool flowHigh = highEntropy;
+		if (k > 0 && !config.flowEntropy.empty()) {
+			flowHigh = config.flowEntropy[(k - 1) % config.flowEntropy.size()] == 'h';
+		}
 //idli1
-	std::string isHigh;
-	if(highEntropy == true) {
-		client.SetAttribute ("IsHighEntropy", UintegerValue (1));
-		isHigh = "h";
-	}else{
-		client.SetAttribute ("IsHighEntropy", UintegerValue (0));
-		isHigh = "l";
+		client.SetAttribute ("IsHighEntropy", UintegerValue (flowHigh ? 1 : 0));
+		if (flowHigh) {
+			client.SetAttribute ("Entropy", DoubleValue (config.entropy));
+			client.SetAttribute ("EntropyPhases", StringValue (config.phases));
+		}
+
+		ApplicationContainer clientApps = client.Install (topology.nodes.Get (0));
+		// a fixed stream per flow keeps generated payloads independent of
+		// how many random variables were created before this experiment
+		DynamicCast<UdpClient> (clientApps.Get (0))->AssignStreams (k);
+
+		clientApps.Start (Seconds (2.0) + MicroSeconds (static_cast<int64_t> (k * config.flowStagger * 1000)));
+		clientApps.Stop (Seconds (40000.0));
+
+		experiment.servers.push_back(server.GetServer());
+		experiment.highEntropy.push_back(flowHigh);
 	}
 
-	ApplicationContainer clientApps = client.Install (nodes.Get (0));
-
-	clientApps.Start (Seconds (2.0));
-	clientApps.Stop (Seconds (40000.0));
-
+	if (config.duplex) {
+		//
+		// Reverse flow, server side to client side: small packets such as
+		// responses or acknowledgements, with the run's entropy, crossing
+		// the link in the other direction while flow 0 is measured.
+		//
+		NS_ABORT_MSG_IF (topology.nextPort == 0, "--reuseTopology ran out of server ports, sweep fewer points per run");
+		uint16_t port = topology.nextPort++;
+		UdpServerHelper server (port);
+		ApplicationContainer serverApps = server.Install (topology.nodes.Get (0));
+		serverApps.Start (Seconds (1.0));
+		serverApps.Stop (Seconds (40000.0));
+
+		UdpClientHelper client (topology.clientAddress, port);
+		client.SetAttribute ("MaxPackets", UintegerValue (config.packetCount));
+		client.SetAttribute ("Interval", TimeValue (NanoSeconds (static_cast<int64_t> (config.interval * 1000))));
+		client.SetAttribute ("BurstSize", UintegerValue (std::max<uint32_t>(burst, 1)));
+		client.SetAttribute ("PacketSize", UintegerValue (config.reverseSize));
+		client.SetAttribute ("PayloadFile", StringValue (config.payloadFile));
+		client.SetAttribute ("IsHighEntropy", UintegerValue (highEntropy ? 1 : 0));
+		if (highEntropy) {
+			client.SetAttribute ("Entropy", DoubleValue (config.entropy));
+			client.SetAttribute ("EntropyPhases", StringValue (config.phases));
+		}
+		ApplicationContainer clientApps = client.Install (topology.nodes.Get (3));
+		DynamicCast<UdpClient> (clientApps.Get (0))->AssignStreams (flows);
+		clientApps.Start (Seconds (2.0));
+		clientApps.Stop (Seconds (40000.0));
+		experiment.reverseServer = server.GetServer();
+	}
 
-	pointToPoint.EnablePcapAll (pcapPrefix+isComp+"_"+"_dr_"+std::to_string(round)+"_ent_"+isHigh +"-");
 
+	// only this experiment's devices, other copies name their own files
+	std::string pcapName = pcapPrefix+isComp+"_"+"_dr_"+round+"_ent_"+isHigh +"-";
+	PcapHelper pcapHelper;
+	for (uint32_t i = 0; i < topology.devices.GetN(); i++) {
+		Ptr<PcapTarget> target = topology.pcap[i];
+		target->file = 0;
+		if (!config.pcap.enabled || !captureDevice(config.pcap.devices, i)) {
+			continue;
+		}
+		std::string filename = pcapHelper.GetFilenameFromDevice (pcapName, topology.devices.Get(i));
+		if (config.pcap.gzip) {
+			filename += ".gz";
+		}
+		target->file = Create<AsyncPcapWriter> (filename, PcapHelper::DLT_PPP, config.pcap.snapLen, config.pcap.gzip);
+		target->origin = Simulator::Now();
+		target->sample = std::max<uint32_t>(config.pcap.sample, 1);
+		target->seen = 0;
+	}
 
-	//start and then destroy simulator
-	Simulator::Run();
-	Simulator::Destroy ();
+	ppp1->DisableQueueSampler();
+	if (config.queueResolution > 0) {
+		ppp1->EnableQueueSampler("queue_"+isComp+"_dr_"+round+"_ent_"+isHigh+".bin", MicroSeconds (config.queueResolution * 1000));
+	}
 
-	return server.GetServer()->deltaTime;
+	experiment.server = experiment.servers[0];
+	experiment.ppp1 = ppp1;
+	experiment.ppp2 = ppp2;
+	experiment.bundle1 = topology.bundle1;
+	experiment.bundle2 = topology.bundle2;
+	experiment.pcap = topology.pcap;
+	return experiment;
 }
-
-
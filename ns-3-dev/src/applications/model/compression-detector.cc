@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "seq-ts-header.h"
+#include "compression-detector.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionDetector");
+
+NS_OBJECT_ENSURE_REGISTERED (CompressionDetector);
+
+TypeId
+CompressionDetector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CompressionDetector")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<CompressionDetector> ()
+    .AddAttribute ("ExpectedPackets",
+                   "Number of packets in the burst whose dispersion is projected.",
+                   UintegerValue (6000),
+                   MakeUintegerAccessor (&CompressionDetector::m_expectedPackets),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("MinSamples",
+                   "Packets to observe before the stopping rule is checked.",
+                   UintegerValue (200),
+                   MakeUintegerAccessor (&CompressionDetector::m_minSamples),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("ConfidenceLevel",
+                   "Two-sided confidence level of the dispersion interval.",
+                   DoubleValue (0.99),
+                   MakeDoubleAccessor (&CompressionDetector::SetConfidenceLevel,
+                                       &CompressionDetector::GetConfidenceLevel),
+                   MakeDoubleChecker<double> (0.5, 0.999999))
+    .AddAttribute ("Tolerance",
+                   "Half width of the interval at which an estimate is final.",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&CompressionDetector::m_tolerance),
+                   MakeTimeChecker ())
+    .AddAttribute ("Threshold",
+                   "Dispersion increase over the reference that means compression.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&CompressionDetector::m_threshold),
+                   MakeTimeChecker ())
+    .AddAttribute ("StopSimulation",
+                   "Call Simulator::Stop as soon as the detector has converged.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&CompressionDetector::m_stopSimulation),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+CompressionDetector::CompressionDetector ()
+  : m_hasReference (false),
+    m_samples (0),
+    m_lastSeq (0),
+    m_slopes (0),
+    m_slopeMean (0),
+    m_slopeM2 (0),
+    m_converged (false),
+    m_detected (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CompressionDetector::~CompressionDetector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CompressionDetector::SetConfidenceLevel (double level)
+{
+  NS_LOG_FUNCTION (this << level);
+  m_confidenceLevel = level;
+  // Invert erf by bisection: z such that P(|N(0,1)| < z) = level.
+  double lo = 0.0;
+  double hi = 10.0;
+  for (int i = 0; i < 64; i++)
+    {
+      double mid = (lo + hi) / 2;
+      if (std::erf (mid / std::sqrt (2.0)) < level)
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+  m_z = (lo + hi) / 2;
+}
+
+double
+CompressionDetector::GetConfidenceLevel (void) const
+{
+  return m_confidenceLevel;
+}
+
+void
+CompressionDetector::SetReference (Time reference)
+{
+  NS_LOG_FUNCTION (this << reference);
+  m_hasReference = true;
+  m_reference = reference;
+}
+
+Time
+CompressionDetector::GetEstimate (void) const
+{
+  return Seconds (m_slopeMean * (m_expectedPackets - 1));
+}
+
+Time
+CompressionDetector::GetHalfWidth (void) const
+{
+  if (m_slopes < 2)
+    {
+      return Time::Max ();
+    }
+  double sd = std::sqrt (m_slopeM2 / (m_slopes - 1));
+  return Seconds (m_z * (m_expectedPackets - 1) * sd / std::sqrt (static_cast<double> (m_slopes)));
+}
+
+uint32_t
+CompressionDetector::GetSamples (void) const
+{
+  return m_samples;
+}
+
+bool
+CompressionDetector::IsConverged (void) const
+{
+  return m_converged;
+}
+
+bool
+CompressionDetector::IsDetected (void) const
+{
+  if (m_converged)
+    {
+      return m_detected;
+    }
+  return GetEstimate () - m_reference >= m_threshold;
+}
+
+void
+CompressionDetector::NotifyRx (Ptr<const Packet> packet)
+{
+  SeqTsHeader seqTs;
+  if (m_converged || packet->GetSize () < seqTs.GetSerializedSize ())
+    {
+      return;
+    }
+  packet->PeekHeader (seqTs);
+  uint32_t seq = seqTs.GetSeq ();
+  Time now = Simulator::Now ();
+
+  if (m_samples > 0 && seq > m_lastSeq)
+    {
+      // one sample per sequence number, so a lost packet does not look
+      // like a doubled service time
+      double slope = (now - m_lastRx).GetSeconds () / (seq - m_lastSeq);
+      m_slopes++;
+      double delta = slope - m_slopeMean;
+      m_slopeMean += delta / m_slopes;
+      m_slopeM2 += delta * (slope - m_slopeMean);
+    }
+  if (m_samples == 0 || seq > m_lastSeq)
+    {
+      m_lastSeq = seq;
+      m_lastRx = now;
+    }
+  m_samples++;
+
+  if (m_samples >= m_minSamples)
+    {
+      Evaluate ();
+    }
+}
+
+void
+CompressionDetector::Evaluate (void)
+{
+  Time halfWidth = GetHalfWidth ();
+  if (m_hasReference)
+    {
+      Time excess = GetEstimate () - m_reference;
+      if (excess - halfWidth >= m_threshold)
+        {
+          m_converged = true;
+          m_detected = true;
+        }
+      else if (excess + halfWidth < m_threshold)
+        {
+          m_converged = true;
+          m_detected = false;
+        }
+    }
+  else if (halfWidth <= m_tolerance)
+    {
+      m_converged = true;
+    }
+
+  if (m_converged)
+    {
+      NS_LOG_INFO ("Converged after " << m_samples << " packets: estimate "
+                   << GetEstimate ().GetMilliSeconds () << " +- "
+                   << halfWidth.GetMilliSeconds () << " ms");
+      if (m_stopSimulation)
+        {
+          Simulator::Stop ();
+        }
+    }
+}
+
+} // namespace ns3
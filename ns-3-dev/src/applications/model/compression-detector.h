@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSION_DETECTOR_H
+#define COMPRESSION_DETECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpclientserver
+ *
+ * \brief Online estimate of the arrival dispersion of a UdpClient burst.
+ *
+ * Connect NotifyRx to the "Rx" trace source of a UdpServer.  Behind the
+ * bottleneck, packets of a burst arrive one service time apart, so the
+ * dispersion of the whole burst (first to last arrival) is projected as
+ * (ExpectedPackets - 1) times the mean per-sequence inter-arrival time,
+ * with a confidence interval derived from the inter-arrival variance.
+ *
+ * Without a reference the detector estimates: it stops the simulation once
+ * the half width of the interval drops below Tolerance.  With a reference
+ * (the dispersion of the low entropy run) it decides: it stops as soon as
+ * the interval of (estimate - reference) lies entirely above or below
+ * Threshold.
+ */
+class CompressionDetector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CompressionDetector ();
+  virtual ~CompressionDetector ();
+
+  /**
+   * \brief Trace sink for UdpServer::Rx
+   * \param packet the received packet, still carrying its SeqTsHeader
+   */
+  void NotifyRx (Ptr<const Packet> packet);
+
+  /**
+   * \brief Switch to decision mode
+   * \param reference dispersion of the low entropy run
+   */
+  void SetReference (Time reference);
+
+  /**
+   * \return the projected dispersion of the whole burst
+   */
+  Time GetEstimate (void) const;
+
+  /**
+   * \return the half width of the confidence interval of GetEstimate
+   */
+  Time GetHalfWidth (void) const;
+
+  /**
+   * \return the number of packets observed
+   */
+  uint32_t GetSamples (void) const;
+
+  /**
+   * \return true once the detector has reached its confidence target
+   */
+  bool IsConverged (void) const;
+
+  /**
+   * \return in decision mode, true if compression was detected
+   */
+  bool IsDetected (void) const;
+
+private:
+  /**
+   * \brief Set the confidence level and the matching normal quantile
+   * \param level two-sided confidence level in (0, 1)
+   */
+  void SetConfidenceLevel (double level);
+
+  /**
+   * \return the confidence level
+   */
+  double GetConfidenceLevel (void) const;
+
+  /// Check the stopping rule after a new sample
+  void Evaluate (void);
+
+  uint32_t m_expectedPackets; //!< Number of packets in the burst
+  uint32_t m_minSamples;      //!< Samples required before stopping
+  double m_confidenceLevel;   //!< Two-sided confidence level
+  double m_z;                 //!< Normal quantile for m_confidenceLevel
+  Time m_tolerance;           //!< Half width target in estimation mode
+  Time m_threshold;           //!< Detection threshold in decision mode
+  bool m_stopSimulation;      //!< Call Simulator::Stop once converged
+
+  bool m_hasReference;   //!< Decision mode
+  Time m_reference;      //!< Low entropy dispersion
+  uint32_t m_samples;    //!< Packets observed
+  uint32_t m_lastSeq;    //!< Sequence number of the last arrival
+  Time m_lastRx;         //!< Time of the last arrival
+  uint32_t m_slopes;     //!< Inter-arrival samples in the mean
+  double m_slopeMean;    //!< Mean seconds per sequence number (Welford)
+  double m_slopeM2;      //!< Sum of squared deviations (Welford)
+  bool m_converged;      //!< Stopping rule satisfied
+  bool m_detected;       //!< Decision, valid once converged with a reference
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSION_DETECTOR_H */
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "hdr-histogram.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HdrHistogram");
+
+HdrHistogram::HdrHistogram (uint32_t precision)
+{
+  Reset (precision);
+}
+
+void
+HdrHistogram::Reset (uint32_t precision)
+{
+  NS_ASSERT_MSG (precision >= 1 && precision <= 16, "HdrHistogram precision must be 1 to 16 bits");
+  m_precision = precision;
+  uint32_t sub = 1u << precision;
+  // exact buckets below 2^precision, then half as many per power of two
+  m_counts.assign (sub + (64 - precision) * (sub / 2 ? sub / 2 : 1), 0);
+  m_count = 0;
+  m_mean = 0;
+  m_m2 = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint32_t
+HdrHistogram::GetPrecision (void) const
+{
+  return m_precision;
+}
+
+uint32_t
+HdrHistogram::GetIndex (uint64_t value) const
+{
+  uint64_t sub = 1ull << m_precision;
+  if (value < sub)
+    {
+      return value;
+    }
+  uint32_t msb = 63;
+  while (!(value >> msb))
+    {
+      msb--;
+    }
+  uint32_t shift = msb - (m_precision - 1);
+  uint64_t half = sub / 2 ? sub / 2 : 1;
+  return sub + (shift - 1) * half + ((value >> shift) - half);
+}
+
+uint64_t
+HdrHistogram::GetValue (uint32_t index) const
+{
+  uint64_t sub = 1ull << m_precision;
+  if (index < sub)
+    {
+      return index;
+    }
+  uint64_t half = sub / 2 ? sub / 2 : 1;
+  uint64_t k = index - sub;
+  uint32_t shift = k / half + 1;
+  uint64_t low = (k % half + half) << shift;
+  return low + ((1ull << shift) - 1) / 2;
+}
+
+void
+HdrHistogram::Record (uint64_t value)
+{
+  m_counts[GetIndex (value)]++;
+  if (m_count == 0 || value < m_min)
+    {
+      m_min = value;
+    }
+  if (value > m_max)
+    {
+      m_max = value;
+    }
+  m_count++;
+  double d = value - m_mean;
+  m_mean += d / m_count;
+  m_m2 += d * (value - m_mean);
+}
+
+uint64_t
+HdrHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+HdrHistogram::GetMean (void) const
+{
+  return m_mean;
+}
+
+double
+HdrHistogram::GetStdDev (void) const
+{
+  return m_count > 1 ? std::sqrt (m_m2 / (m_count - 1)) : 0;
+}
+
+uint64_t
+HdrHistogram::GetMin (void) const
+{
+  return m_min;
+}
+
+uint64_t
+HdrHistogram::GetMax (void) const
+{
+  return m_max;
+}
+
+uint64_t
+HdrHistogram::GetPercentile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = static_cast<uint64_t> (std::ceil (q * m_count));
+  rank = rank ? rank : 1;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          uint64_t v = GetValue (i);
+          return v < m_min ? m_min : (v > m_max ? m_max : v);
+        }
+    }
+  return m_max;
+}
+
+} // namespace ns3
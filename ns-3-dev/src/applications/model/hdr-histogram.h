@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HDR_HISTOGRAM_H
+#define HDR_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Constant memory histogram of non-negative integer values.
+ *
+ * Values below 2^precision are counted exactly; larger values fall in
+ * log-linear buckets whose width is at most 2^(1-precision) of their
+ * value, in the spirit of Gil Tene's HdrHistogram.  The whole 64 bit range
+ * is covered by a fixed array (about 30 KB at the default precision of 7
+ * bits, i.e. better than 1% relative error), so recording is a few shifts
+ * and an increment.  Count, mean, variance, minimum and maximum are kept
+ * exactly as streaming statistics.
+ */
+class HdrHistogram
+{
+public:
+  /**
+   * \param precision number of significant bits kept per value (1-16)
+   */
+  HdrHistogram (uint32_t precision = 7);
+
+  /**
+   * \brief Drop every value and change the precision
+   * \param precision number of significant bits kept per value (1-16)
+   */
+  void Reset (uint32_t precision);
+
+  /**
+   * \return the number of significant bits kept per value
+   */
+  uint32_t GetPrecision (void) const;
+
+  /**
+   * \brief Add a value
+   * \param value the value
+   */
+  void Record (uint64_t value);
+
+  /**
+   * \return the number of values recorded
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \return the exact mean of the values, 0 if none
+   */
+  double GetMean (void) const;
+
+  /**
+   * \return the exact standard deviation of the values, 0 if less than two
+   */
+  double GetStdDev (void) const;
+
+  /**
+   * \return the smallest value, 0 if none
+   */
+  uint64_t GetMin (void) const;
+
+  /**
+   * \return the largest value, 0 if none
+   */
+  uint64_t GetMax (void) const;
+
+  /**
+   * \brief Get a percentile, within the bucket precision
+   * \param q the quantile, between 0 and 1
+   * \return the value below which a fraction q of the values fall
+   */
+  uint64_t GetPercentile (double q) const;
+
+private:
+  /**
+   * \param value a value
+   * \return the index of its bucket
+   */
+  uint32_t GetIndex (uint64_t value) const;
+
+  /**
+   * \param index a bucket index
+   * \return a value representative of the bucket (its midpoint)
+   */
+  uint64_t GetValue (uint32_t index) const;
+
+  uint32_t m_precision;          //!< Significant bits per value
+  std::vector<uint64_t> m_counts; //!< Bucket counters
+  uint64_t m_count;              //!< Values recorded
+  double m_mean;                 //!< Running mean (Welford)
+  double m_m2;                   //!< Sum of squared deviations (Welford)
+  uint64_t m_min;                //!< Smallest value
+  uint64_t m_max;                //!< Largest value
+};
+
+} // namespace ns3
+
+#endif /* HDR_HISTOGRAM_H */
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "latency-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LatencyTag");
+
+NS_OBJECT_ENSURE_REGISTERED (LatencyTag);
+
+TypeId
+LatencyTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LatencyTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<LatencyTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+LatencyTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+LatencyTag::LatencyTag ()
+  : m_last (0)
+{
+  for (int c = 0; c < N_COMPONENTS; c++)
+    {
+      m_component[c] = 0;
+    }
+}
+
+uint32_t
+LatencyTag::GetSerializedSize (void) const
+{
+  return 8 * (1 + N_COMPONENTS);
+}
+
+void
+LatencyTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_last);
+  for (int c = 0; c < N_COMPONENTS; c++)
+    {
+      i.WriteU64 (m_component[c]);
+    }
+}
+
+void
+LatencyTag::Deserialize (TagBuffer i)
+{
+  m_last = i.ReadU64 ();
+  for (int c = 0; c < N_COMPONENTS; c++)
+    {
+      m_component[c] = i.ReadU64 ();
+    }
+}
+
+void
+LatencyTag::Print (std::ostream &os) const
+{
+  for (int c = 0; c < N_COMPONENTS; c++)
+    {
+      os << (c ? " " : "") << GetComponentName (Component (c)) << "="
+         << TimeStep (m_component[c]).GetMicroSeconds () << "us";
+    }
+}
+
+void
+LatencyTag::Start (Time now)
+{
+  m_last = now.GetTimeStep ();
+  for (int c = 0; c < N_COMPONENTS; c++)
+    {
+      m_component[c] = 0;
+    }
+}
+
+void
+LatencyTag::Stamp (Component c, Time now)
+{
+  m_component[c] += now.GetTimeStep () - m_last;
+  m_last = now.GetTimeStep ();
+}
+
+Time
+LatencyTag::Get (Component c) const
+{
+  return TimeStep (m_component[c]);
+}
+
+const char *
+LatencyTag::GetComponentName (Component c)
+{
+  switch (c)
+    {
+    case STACK:
+      return "stack";
+    case QUEUE:
+      return "queue";
+    case SERIALIZATION:
+      return "serialization";
+    case PROPAGATION:
+      return "propagation";
+    default:
+      return "unknown";
+    }
+}
+
+void
+LatencyTag::StampPacket (Ptr<Packet> p, Component c, Time now)
+{
+  LatencyTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      tag.Stamp (c, now);
+      p->ReplacePacketTag (tag);
+    }
+}
+
+} // namespace ns3
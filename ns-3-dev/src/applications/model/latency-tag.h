@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LATENCY_TAG_H
+#define LATENCY_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup applications
+ * \brief Packet tag splitting the one-way delay of a packet by cause.
+ *
+ * The sender starts the tag; every stage the packet crosses then stamps
+ * it, which charges the time elapsed since the previous stamp to one
+ * component.  A PointToPointNetDevice stamps STACK when the packet is
+ * handed to it, QUEUE and SERIALIZATION when the transmission starts and
+ * PROPAGATION on reception; the receiver stamps STACK once more before
+ * reading the totals.  The components add up to the end-to-end delay.
+ *
+ * There is no codec component: compression and decompression take no
+ * simulated time, so its share would always be zero.
+ */
+class LatencyTag : public Tag
+{
+public:
+  /// Causes of delay
+  enum Component
+  {
+    STACK = 0,      //!< Protocol stacks and forwarding between devices
+    QUEUE,          //!< Waiting in a device transmit queue
+    SERIALIZATION,  //!< Putting the bits on the wire
+    PROPAGATION,    //!< Channel delay
+    N_COMPONENTS
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  LatencyTag ();
+
+  /**
+   * \brief Reset every component and start timing
+   * \param now the time the packet leaves the sender
+   */
+  void Start (Time now);
+
+  /**
+   * \brief Charge the time since the previous stamp to a component
+   * \param c the component
+   * \param now the time of this stamp
+   */
+  void Stamp (Component c, Time now);
+
+  /**
+   * \param c the component
+   * \return the time charged to the component so far
+   */
+  Time Get (Component c) const;
+
+  /**
+   * \param c the component
+   * \return the component name, as used in reports
+   */
+  static const char * GetComponentName (Component c);
+
+  /**
+   * \brief Stamp the tag of a packet, if it carries one
+   * \param p the packet
+   * \param c the component
+   * \param now the time of the stamp, may be in the future when the end
+   * of a stage is already known
+   */
+  static void StampPacket (Ptr<Packet> p, Component c, Time now);
+
+private:
+  int64_t m_last;                      //!< Time of the previous stamp, in time steps
+  int64_t m_component[N_COMPONENTS];   //!< Time charged to each component, in time steps
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_TAG_H */
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "results-sink.h"
+#include <sstream>
+#include <limits>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ResultsSink");
+
+namespace {
+
+template <typename T>
+void
+Put (std::string &buffer, T value)
+{
+  buffer.append (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+// RFC 4180 quoting, only when needed
+std::string
+Quote (const std::string &s)
+{
+  if (s.find_first_of (",\"\r\n") == std::string::npos)
+    {
+      return s;
+    }
+  std::string q = "\"";
+  for (size_t i = 0; i < s.size (); i++)
+    {
+      q += s[i];
+      if (s[i] == '"')
+        {
+          q += '"';
+        }
+    }
+  return q + "\"";
+}
+
+} // anonymous namespace
+
+uint32_t
+ResultsSink::Record::Find (const std::string &name, ColumnType type) const
+{
+  for (uint32_t i = 0; i < m_columns->size (); i++)
+    {
+      if ((*m_columns)[i].name == name)
+        {
+          NS_ABORT_MSG_IF ((*m_columns)[i].type != type, "ResultsSink: wrong type for column " << name);
+          return i;
+        }
+    }
+  NS_ABORT_MSG ("ResultsSink: no column " << name);
+  return 0;
+}
+
+ResultsSink::Record &
+ResultsSink::Record::Set (const std::string &name, int64_t value)
+{
+  m_integer[Find (name, INTEGER)] = value;
+  return *this;
+}
+
+ResultsSink::Record &
+ResultsSink::Record::Set (const std::string &name, double value)
+{
+  m_real[Find (name, REAL)] = value;
+  return *this;
+}
+
+ResultsSink::Record &
+ResultsSink::Record::Set (const std::string &name, const std::string &value)
+{
+  m_text[Find (name, TEXT)] = value;
+  return *this;
+}
+
+ResultsSink::ResultsSink (const std::string &csvFile, const std::vector<Column> &columns,
+                          const std::string &binaryFile, uint32_t bufferRows)
+  : m_columns (columns),
+    m_binary (-1),
+    m_bufferRows (std::max<uint32_t> (bufferRows, 1))
+{
+  NS_LOG_FUNCTION (this << csvFile << binaryFile << bufferRows);
+  m_csv = open (csvFile.c_str (), O_RDWR | O_CREAT | O_APPEND, 0644);
+  NS_ABORT_MSG_IF (m_csv < 0, "ResultsSink: cannot open " << csvFile);
+  flock (m_csv, LOCK_SH);
+  bool matches = HeaderMatches (m_csv, Header ());
+  flock (m_csv, LOCK_UN);
+  NS_ABORT_MSG_IF (!matches, "ResultsSink: " << csvFile << " was written with other columns, move it away");
+  if (!binaryFile.empty ())
+    {
+      m_binary = open (binaryFile.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+      NS_ABORT_MSG_IF (m_binary < 0, "ResultsSink: cannot open " << binaryFile);
+    }
+  m_records.reserve (m_bufferRows);
+}
+
+ResultsSink::~ResultsSink ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  close (m_csv);
+  if (m_binary >= 0)
+    {
+      close (m_binary);
+    }
+}
+
+ResultsSink::Record
+ResultsSink::NewRecord (void) const
+{
+  Record record;
+  record.m_columns = &m_columns;
+  record.m_integer.assign (m_columns.size (), 0);
+  record.m_real.assign (m_columns.size (), 0);
+  record.m_text.assign (m_columns.size (), "");
+  return record;
+}
+
+void
+ResultsSink::Write (const Record &record)
+{
+  NS_ASSERT_MSG (record.m_columns == &m_columns, "ResultsSink: record of another sink");
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_records.push_back (record);
+  if (m_records.size () >= m_bufferRows)
+    {
+      FlushLocked ();
+    }
+}
+
+void
+ResultsSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::lock_guard<std::mutex> lock (m_mutex);
+  FlushLocked ();
+}
+
+void
+ResultsSink::FlushLocked (void)
+{
+  if (m_records.empty ())
+    {
+      return;
+    }
+
+  std::ostringstream csv;
+  csv.precision (std::numeric_limits<double>::digits10);
+  for (size_t r = 0; r < m_records.size (); r++)
+    {
+      for (uint32_t c = 0; c < m_columns.size (); c++)
+        {
+          csv << (c ? "," : "");
+          switch (m_columns[c].type)
+            {
+            case INTEGER:
+              csv << m_records[r].m_integer[c];
+              break;
+            case REAL:
+              csv << m_records[r].m_real[c];
+              break;
+            case TEXT:
+              csv << Quote (m_records[r].m_text[c]);
+              break;
+            }
+        }
+      csv << "\n";
+    }
+  NS_ABORT_MSG_IF (!Append (m_csv, Header (), csv.str ()),
+                   "ResultsSink: the CSV file was written with other columns");
+
+  if (m_binary >= 0)
+    {
+      std::string block ("RSNK");
+      Put<uint32_t> (block, 1);
+      Put<uint32_t> (block, m_columns.size ());
+      Put<uint32_t> (block, m_records.size ());
+      for (uint32_t c = 0; c < m_columns.size (); c++)
+        {
+          Put<uint8_t> (block, m_columns[c].type);
+          Put<uint16_t> (block, m_columns[c].name.size ());
+          block += m_columns[c].name;
+        }
+      for (uint32_t c = 0; c < m_columns.size (); c++)
+        {
+          for (size_t r = 0; r < m_records.size (); r++)
+            {
+              switch (m_columns[c].type)
+                {
+                case INTEGER:
+                  Put<int64_t> (block, m_records[r].m_integer[c]);
+                  break;
+                case REAL:
+                  Put<double> (block, m_records[r].m_real[c]);
+                  break;
+                case TEXT:
+                  Put<uint32_t> (block, m_records[r].m_text[c].size ());
+                  block += m_records[r].m_text[c];
+                  break;
+                }
+            }
+        }
+      Append (m_binary, "", block);
+    }
+
+  m_records.clear ();
+}
+
+std::string
+ResultsSink::Header (void) const
+{
+  std::string header;
+  for (uint32_t c = 0; c < m_columns.size (); c++)
+    {
+      header += (c ? "," : "") + Quote (m_columns[c].name);
+    }
+  return header + "\n";
+}
+
+bool
+ResultsSink::HeaderMatches (int fd, const std::string &header)
+{
+  if (lseek (fd, 0, SEEK_END) == 0)
+    {
+      return true;
+    }
+  std::string first (header.size (), '\0');
+  ssize_t n = pread (fd, &first[0], first.size (), 0);
+  return n == ssize_t (header.size ()) && first == header;
+}
+
+bool
+ResultsSink::Append (int fd, const std::string &header, const std::string &data)
+{
+  flock (fd, LOCK_EX);
+  std::string out;
+  if (!header.empty ())
+    {
+      if (!HeaderMatches (fd, header))
+        {
+          flock (fd, LOCK_UN);
+          return false;
+        }
+      if (lseek (fd, 0, SEEK_END) == 0)
+        {
+          out = header;
+        }
+    }
+  out += data;
+  size_t done = 0;
+  while (done < out.size ())
+    {
+      ssize_t n = write (fd, out.data () + done, out.size () - done);
+      if (n < 0)
+        {
+          NS_LOG_ERROR ("ResultsSink: write failed, " << out.size () - done << " bytes lost");
+          break;
+        }
+      done += n;
+    }
+  flock (fd, LOCK_UN);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RESULTS_SINK_H
+#define RESULTS_SINK_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Typed table of results, buffered and appended to a CSV file.
+ *
+ * The columns are fixed when the sink is created.  Records are kept in
+ * memory and appended in blocks of complete rows, with one write per
+ * block on a file held open for the lifetime of the sink, under an
+ * advisory lock.  Several threads may share a sink, and several processes
+ * (e.g. a sweep split across machines sharing a directory) may append to
+ * the same file: their rows never interleave and the header line is only
+ * written to an empty file.  A file whose header line names other columns
+ * is never appended to; the sink aborts instead, both when it is created
+ * and when it writes a block.
+ *
+ * Rows only reach the file when a block fills up, on Flush, or when the
+ * sink is destroyed, so callers flush at points they must not lose.
+ *
+ * An optional binary file receives the same blocks in columnar form, all
+ * fields in host byte order:
+ *
+ *   - "RSNK", uint32 version (1), uint32 columns, uint32 rows
+ *   - per column: uint8 type, uint16 name length, name
+ *   - per column: rows int64 (INTEGER), rows double (REAL) or, for TEXT,
+ *     rows times a uint32 length and the bytes
+ */
+class ResultsSink : public SimpleRefCount<ResultsSink>
+{
+public:
+  /// Type of a column
+  enum ColumnType
+  {
+    INTEGER = 0,
+    REAL = 1,
+    TEXT = 2
+  };
+
+  /// Name and type of a column
+  struct Column
+  {
+    std::string name; //!< Column name, used in the header
+    ColumnType type;  //!< Column type
+  };
+
+  /// One row, filled by column name
+  class Record
+  {
+public:
+    /**
+     * \param name the column
+     * \param value the value of an INTEGER column
+     * \return this record
+     */
+    Record & Set (const std::string &name, int64_t value);
+    /**
+     * \param name the column
+     * \param value the value of a REAL column
+     * \return this record
+     */
+    Record & Set (const std::string &name, double value);
+    /**
+     * \param name the column
+     * \param value the value of a TEXT column
+     * \return this record
+     */
+    Record & Set (const std::string &name, const std::string &value);
+
+private:
+    friend class ResultsSink;
+    /**
+     * \param name the column
+     * \param type the type of the value
+     * \return the index of the column
+     */
+    uint32_t Find (const std::string &name, ColumnType type) const;
+
+    const std::vector<Column> *m_columns; //!< Columns of the sink
+    std::vector<int64_t> m_integer;       //!< INTEGER values by column
+    std::vector<double> m_real;           //!< REAL values by column
+    std::vector<std::string> m_text;      //!< TEXT values by column
+  };
+
+  /**
+   * \param csvFile the CSV file, appended to
+   * \param columns the columns of every record
+   * \param binaryFile the columnar file, appended to, empty for none
+   * \param bufferRows records kept in memory before a block is written
+   */
+  ResultsSink (const std::string &csvFile, const std::vector<Column> &columns,
+               const std::string &binaryFile = "", uint32_t bufferRows = 1024);
+  ~ResultsSink ();
+
+  /**
+   * \return an empty record for this sink, unset values are 0 or empty
+   */
+  Record NewRecord (void) const;
+
+  /**
+   * \brief Queue a record, writing a block once enough are buffered
+   * \param record the record, from NewRecord
+   */
+  void Write (const Record &record);
+
+  /**
+   * \brief Write every buffered record
+   */
+  void Flush (void);
+
+private:
+  ResultsSink (const ResultsSink &);
+  ResultsSink & operator = (const ResultsSink &);
+
+  /// Write the buffered records, with m_mutex held
+  void FlushLocked (void);
+
+  /**
+   * \return the CSV header line of the columns, with its newline
+   */
+  std::string Header (void) const;
+
+  /**
+   * \param fd the file, open for reading
+   * \param header the expected header line
+   * \return true if the file is empty or starts with header
+   */
+  static bool HeaderMatches (int fd, const std::string &header);
+
+  /**
+   * \brief Append a block to a file under an exclusive lock
+   * \param fd the file
+   * \param header written first if the file is empty, empty for none
+   * \param data the block
+   * \return false, writing nothing, if the file starts with another header
+   */
+  static bool Append (int fd, const std::string &header, const std::string &data);
+
+  std::vector<Column> m_columns; //!< Columns of every record
+  int m_csv;                     //!< CSV file descriptor
+  int m_binary;                  //!< Columnar file descriptor, -1 if none
+  uint32_t m_bufferRows;         //!< Records per block
+  std::vector<Record> m_records; //!< Records not written yet
+  std::mutex m_mutex;            //!< Protects m_records and the files
+};
+
+} // namespace ns3
+
+#endif /* RESULTS_SINK_H */
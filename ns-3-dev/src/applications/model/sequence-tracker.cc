@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "sequence-tracker.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SequenceTracker");
+
+namespace {
+
+uint32_t
+PopCount (uint64_t x)
+{
+  return __builtin_popcountll (x);
+}
+
+} // anonymous namespace
+
+SequenceTracker::SequenceTracker (uint32_t window)
+{
+  SetWindow (window);
+}
+
+void
+SequenceTracker::SetWindow (uint32_t window)
+{
+  NS_LOG_FUNCTION (this << window);
+  uint64_t words = std::max<uint64_t> ((window + 63) / 64, 1);
+  m_window = words * 64;
+  m_bits.assign (words, 0);
+  m_next = 0;
+  m_lost = 0;
+  m_reordered = 0;
+  m_maxReorder = 0;
+  m_duplicates = 0;
+  m_late = 0;
+}
+
+uint32_t
+SequenceTracker::GetWindow (void) const
+{
+  return m_window;
+}
+
+bool
+SequenceTracker::Test (uint64_t seq) const
+{
+  uint64_t slot = seq % m_window;
+  return (m_bits[slot / 64] >> (slot % 64)) & 1;
+}
+
+void
+SequenceTracker::Set (uint64_t seq)
+{
+  uint64_t slot = seq % m_window;
+  m_bits[slot / 64] |= 1ull << (slot % 64);
+}
+
+uint64_t
+SequenceTracker::GetBase (void) const
+{
+  return m_next > m_window ? m_next - m_window : 0;
+}
+
+uint64_t
+SequenceTracker::CountWindow (void) const
+{
+  uint64_t n = 0;
+  for (size_t i = 0; i < m_bits.size (); i++)
+    {
+      n += PopCount (m_bits[i]);
+    }
+  return n;
+}
+
+void
+SequenceTracker::NotifyReceived (uint64_t seq)
+{
+  if (seq >= m_next)
+    {
+      uint64_t oldBase = GetBase ();
+      uint64_t newBase = seq + 1 > m_window ? seq + 1 - m_window : 0;
+      if (newBase - oldBase >= m_window)
+        {
+          // the whole window leaves at once
+          m_lost += (newBase - oldBase) - CountWindow ();
+          std::fill (m_bits.begin (), m_bits.end (), 0);
+        }
+      else
+        {
+          for (uint64_t s = oldBase; s < newBase; s++)
+            {
+              uint64_t slot = s % m_window;
+              uint64_t mask = 1ull << (slot % 64);
+              if (!(m_bits[slot / 64] & mask))
+                {
+                  m_lost++;
+                }
+              m_bits[slot / 64] &= ~mask;
+            }
+        }
+      Set (seq);
+      m_next = seq + 1;
+    }
+  else if (seq >= GetBase ())
+    {
+      if (Test (seq))
+        {
+          m_duplicates++;
+          return;
+        }
+      Set (seq);
+      m_reordered++;
+      m_maxReorder = std::max (m_maxReorder, m_next - 1 - seq);
+    }
+  else
+    {
+      m_late++;
+    }
+}
+
+uint64_t
+SequenceTracker::Unwrap (uint32_t seq) const
+{
+  int64_t s = int64_t (m_next) + int32_t (seq - uint32_t (m_next));
+  return s < 0 ? seq : s;
+}
+
+uint64_t
+SequenceTracker::GetLost (void) const
+{
+  return m_lost + (m_next - GetBase ()) - CountWindow ();
+}
+
+uint64_t
+SequenceTracker::GetReordered (void) const
+{
+  return m_reordered;
+}
+
+uint64_t
+SequenceTracker::GetMaxReorder (void) const
+{
+  return m_maxReorder;
+}
+
+uint64_t
+SequenceTracker::GetDuplicates (void) const
+{
+  return m_duplicates;
+}
+
+uint64_t
+SequenceTracker::GetLate (void) const
+{
+  return m_late;
+}
+
+} // namespace ns3
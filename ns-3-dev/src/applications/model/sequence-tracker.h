@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Loss, reordering and duplicate accounting over a sliding window.
+ *
+ * One bit per sequence number is kept for the last window sequence
+ * numbers below the highest one received, in a ring of 64 bit words.
+ * Sequence numbers leaving the window without having been received are
+ * counted as lost, so memory does not depend on the length of the flow
+ * and each sequence number costs O(1) amortized.  A packet arriving
+ * further behind than the window is counted as late (it was already
+ * counted as lost).
+ */
+class SequenceTracker
+{
+public:
+  /**
+   * \param window sequence numbers tracked, rounded up to a multiple of 64
+   */
+  SequenceTracker (uint32_t window = 65536);
+
+  /**
+   * \brief Change the window, forgetting every sequence number
+   * \param window sequence numbers tracked, rounded up to a multiple of 64
+   */
+  void SetWindow (uint32_t window);
+
+  /**
+   * \return the number of sequence numbers tracked
+   */
+  uint32_t GetWindow (void) const;
+
+  /**
+   * \brief Record the arrival of a packet
+   * \param seq its sequence number
+   */
+  void NotifyReceived (uint64_t seq);
+
+  /**
+   * \brief Extend a 32 bit sequence number that may have wrapped around
+   * \param seq the low 32 bits of a sequence number
+   * \return the sequence number with those low bits closest to the
+   * highest one received
+   */
+  uint64_t Unwrap (uint32_t seq) const;
+
+  /**
+   * \return sequence numbers below the highest received that never arrived
+   */
+  uint64_t GetLost (void) const;
+
+  /**
+   * \return packets that arrived after a higher sequence number
+   */
+  uint64_t GetReordered (void) const;
+
+  /**
+   * \return the largest distance, in sequence numbers, a packet arrived late by
+   */
+  uint64_t GetMaxReorder (void) const;
+
+  /**
+   * \return packets whose sequence number had already arrived
+   */
+  uint64_t GetDuplicates (void) const;
+
+  /**
+   * \return packets that arrived behind the window
+   */
+  uint64_t GetLate (void) const;
+
+private:
+  /**
+   * \param seq a sequence number inside the window
+   * \return whether it was received
+   */
+  bool Test (uint64_t seq) const;
+
+  /**
+   * \param seq a sequence number inside the window
+   */
+  void Set (uint64_t seq);
+
+  /**
+   * \return the number of received sequence numbers inside the window
+   */
+  uint64_t CountWindow (void) const;
+
+  /**
+   * \return the lowest sequence number inside the window
+   */
+  uint64_t GetBase (void) const;
+
+  uint64_t m_window;            //!< Sequence numbers tracked
+  std::vector<uint64_t> m_bits; //!< Ring of received bits, seq at seq % m_window
+  uint64_t m_next;              //!< One past the highest sequence number received
+  uint64_t m_lost;              //!< Lost sequence numbers that left the window
+  uint64_t m_reordered;         //!< Out of order arrivals
+  uint64_t m_maxReorder;        //!< Largest reorder distance
+  uint64_t m_duplicates;        //!< Duplicate arrivals
+  uint64_t m_late;              //!< Arrivals behind the window
+};
+
+} // namespace ns3
+
+#endif /* SEQUENCE_TRACKER_H */
@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "trace-reader.h"
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceReader");
+
+namespace {
+
+const uint32_t PCAP_MAGIC_US = 0xa1b2c3d4;
+const uint32_t PCAP_MAGIC_NS = 0xa1b23c4d;
+
+uint32_t
+Swap32 (uint32_t x)
+{
+  return ((x & 0xff) << 24) | ((x & 0xff00) << 8) | ((x >> 8) & 0xff00) | (x >> 24);
+}
+
+uint16_t
+Be16 (const uint8_t *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+} // anonymous namespace
+
+TraceReader::TraceReader ()
+  : m_data (0),
+    m_length (0),
+    m_offset (0),
+    m_start (0),
+    m_pcap (false),
+    m_swapped (false),
+    m_nanoseconds (false),
+    m_linkType (0),
+    m_first (-1)
+{
+}
+
+TraceReader::~TraceReader ()
+{
+  Close ();
+}
+
+void
+TraceReader::Open (const std::string &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  Close ();
+  int fd = open (filename.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "TraceReader: cannot open " << filename);
+  struct stat st;
+  NS_ABORT_MSG_IF (fstat (fd, &st) != 0 || st.st_size == 0, "TraceReader: " << filename << " is empty");
+  m_length = st.st_size;
+  void *map = mmap (0, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (map == MAP_FAILED, "TraceReader: cannot map " << filename);
+  madvise (map, m_length, MADV_SEQUENTIAL);
+  m_data = static_cast<const uint8_t *> (map);
+
+  uint32_t magic = m_length >= 24 ? *reinterpret_cast<const uint32_t *> (m_data) : 0;
+  m_pcap = true;
+  if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS)
+    {
+      m_swapped = false;
+    }
+  else if (Swap32 (magic) == PCAP_MAGIC_US || Swap32 (magic) == PCAP_MAGIC_NS)
+    {
+      m_swapped = true;
+    }
+  else
+    {
+      m_pcap = false;
+    }
+  if (m_pcap)
+    {
+      m_nanoseconds = Read32 (m_data) == PCAP_MAGIC_NS;
+      m_linkType = Read32 (m_data + 20) & 0xffff;
+      m_start = 24;
+    }
+  else
+    {
+      m_start = 0;
+    }
+  Rewind ();
+}
+
+void
+TraceReader::Close (void)
+{
+  if (m_data != 0)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_length);
+      m_data = 0;
+      m_length = 0;
+    }
+}
+
+bool
+TraceReader::IsOpen (void) const
+{
+  return m_data != 0;
+}
+
+void
+TraceReader::Rewind (void)
+{
+  m_offset = m_start;
+  m_first = -1;
+}
+
+uint32_t
+TraceReader::Read32 (const uint8_t *p) const
+{
+  uint32_t x = *reinterpret_cast<const uint32_t *> (p);
+  return m_swapped ? Swap32 (x) : x;
+}
+
+bool
+TraceReader::Next (Record &record)
+{
+  if (m_data == 0)
+    {
+      return false;
+    }
+  return m_pcap ? NextPcap (record) : NextText (record);
+}
+
+bool
+TraceReader::NextPcap (Record &record)
+{
+  if (m_offset + 16 > m_length)
+    {
+      return false;
+    }
+  const uint8_t *h = m_data + m_offset;
+  int64_t t = Read32 (h) * 1000000000LL + Read32 (h + 4) * (m_nanoseconds ? 1 : 1000);
+  uint32_t captured = Read32 (h + 8);
+  uint32_t original = Read32 (h + 12);
+  if (m_offset + 16 + captured > m_length)
+    {
+      // cut short by the end of a capture still being written
+      return false;
+    }
+  if (m_first < 0)
+    {
+      m_first = t;
+    }
+  record.time = NanoSeconds (t - m_first);
+  Dissect (h + 16, captured, std::max (original, captured), record);
+  m_offset += 16 + captured;
+  return true;
+}
+
+bool
+TraceReader::NextText (Record &record)
+{
+  while (m_offset < m_length)
+    {
+      // copy the line so strtod never reads past the mapping
+      size_t end = m_offset;
+      while (end < m_length && m_data[end] != '\n')
+        {
+          end++;
+        }
+      std::string line (reinterpret_cast<const char *> (m_data + m_offset), end - m_offset);
+      m_offset = end + 1;
+      char *rest;
+      double seconds = std::strtod (line.c_str (), &rest);
+      if (rest == line.c_str ())
+        {
+          continue; // blank or comment line
+        }
+      unsigned long size = std::strtoul (rest, 0, 10);
+      int64_t t = static_cast<int64_t> (seconds * 1e9);
+      if (m_first < 0)
+        {
+          m_first = t;
+        }
+      record.time = NanoSeconds (t - m_first);
+      record.payload = 0;
+      record.captured = 0;
+      record.size = size;
+      return true;
+    }
+  return false;
+}
+
+void
+TraceReader::Dissect (const uint8_t *frame, uint32_t captured, uint32_t original, Record &record) const
+{
+  uint32_t offset = 0;
+  uint16_t protocol = 0;   // ethertype of the network header
+  switch (m_linkType)
+    {
+    case 1:     // Ethernet
+      offset = 14;
+      protocol = captured >= 14 ? Be16 (frame + 12) : 0;
+      if (protocol == 0x8100 && captured >= 18)
+        {
+          offset = 18;
+          protocol = Be16 (frame + 16);
+        }
+      break;
+    case 9:     // PPP
+      offset = 2;
+      protocol = captured >= 2 ? Be16 (frame) : 0;
+      protocol = protocol == 0x0021 ? 0x0800 : (protocol == 0x0057 ? 0x86dd : 0);
+      break;
+    case 113:   // Linux cooked
+      offset = 16;
+      protocol = captured >= 16 ? Be16 (frame + 14) : 0;
+      break;
+    case 101:   // raw IP
+    case 228:   // IPv4
+    case 229:   // IPv6
+      protocol = captured >= 1 ? ((frame[0] >> 4) == 6 ? 0x86dd : 0x0800) : 0;
+      break;
+    default:
+      break;
+    }
+
+  uint8_t transport = 0;
+  if (protocol == 0x0800 && captured >= offset + 20)
+    {
+      transport = frame[offset + 9];
+      offset += (frame[offset] & 0x0f) * 4;
+    }
+  else if (protocol == 0x86dd && captured >= offset + 40)
+    {
+      transport = frame[offset + 6];
+      offset += 40;
+    }
+  else
+    {
+      offset = 0;   // not IP, or truncated before the IP header
+    }
+  if (transport == 17)
+    {
+      offset += 8;
+    }
+  else if (transport == 6 && captured >= offset + 13)
+    {
+      offset += (frame[offset + 12] >> 4) * 4;
+    }
+
+  offset = std::min (offset, original);
+  record.payload = frame + std::min (offset, captured);
+  record.captured = captured > offset ? captured - offset : 0;
+  record.size = original - offset;
+}
+
+} // namespace ns3
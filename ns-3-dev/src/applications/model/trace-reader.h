@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief Sequential reader of a packet trace, memory-mapped.
+ *
+ * Two formats are recognized from the first bytes of the file:
+ *
+ *   - pcap, either byte order, micro or nanosecond timestamps, with
+ *     Ethernet, PPP, Linux cooked or raw IP link types.  The payload of a
+ *     record is what follows its UDP or TCP header, or the IP header for
+ *     other protocols, or the whole frame when it is not IP.
+ *   - text, one "time size" line per packet, time in seconds and size in
+ *     bytes; records have no payload bytes.
+ *
+ * The file is mapped, not read, so a trace of any length costs no heap
+ * memory and the pages are only touched once, in order.  A record's
+ * payload points into the mapping and stays valid until Close.
+ */
+class TraceReader
+{
+public:
+  /// One packet of the trace
+  struct Record
+  {
+    Time time;              //!< Time since the first record
+    const uint8_t *payload; //!< Captured payload bytes
+    uint32_t captured;      //!< Number of bytes at payload
+    uint32_t size;          //!< Original payload size, at least captured
+  };
+
+  TraceReader ();
+  ~TraceReader ();
+
+  /**
+   * \brief Map a trace file, aborting if it cannot be read
+   * \param filename the pcap or text trace
+   */
+  void Open (const std::string &filename);
+
+  /**
+   * \brief Unmap the file
+   */
+  void Close (void);
+
+  /**
+   * \return whether a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \brief Read the next record
+   * \param record filled with the record
+   * \return false at the end of the trace
+   */
+  bool Next (Record &record);
+
+  /**
+   * \brief Go back to the first record
+   */
+  void Rewind (void);
+
+private:
+  TraceReader (const TraceReader &);
+  TraceReader & operator = (const TraceReader &);
+
+  /**
+   * \return a 32 bit pcap header field in the byte order of the file
+   * \param p the field
+   */
+  uint32_t Read32 (const uint8_t *p) const;
+
+  /// \copydoc Next
+  bool NextPcap (Record &record);
+  /// \copydoc Next
+  bool NextText (Record &record);
+
+  /**
+   * \brief Find the payload of a frame
+   * \param frame the captured frame
+   * \param captured its captured length
+   * \param original its original length
+   * \param record receives payload, captured and size
+   */
+  void Dissect (const uint8_t *frame, uint32_t captured, uint32_t original, Record &record) const;
+
+  const uint8_t *m_data;  //!< Mapped file
+  size_t m_length;        //!< Length of the mapping
+  size_t m_offset;        //!< Offset of the next record
+  size_t m_start;         //!< Offset of the first record
+  bool m_pcap;            //!< pcap rather than text
+  bool m_swapped;         //!< pcap written in the other byte order
+  bool m_nanoseconds;     //!< pcap timestamps in ns
+  uint32_t m_linkType;    //!< pcap data link type
+  int64_t m_first;        //!< Time of the first record in ns, -1 before it
+};
+
+} // namespace ns3
+
+#endif /* TRACE_READER_H */
@@ -28,8 +28,13 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
 #include "udp-client.h"
 #include "seq-ts-header.h"
+#include "latency-tag.h"
 #include <cstdlib>
 #include <cstdio>
 #include <iostream> 
@@ -39,6 +44,8 @@
 #include <fstream>
 #include <cstdlib>
 #include <random>
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -62,6 +69,12 @@ namespace ns3 {
 						"The time to wait between packets", TimeValue (Seconds (1.0)),
 						MakeTimeAccessor (&UdpClient::m_interval),
 						MakeTimeChecker ())
+				.AddAttribute ("BurstSize",
+						"The number of packets sent back to back by each send event, Interval apart. "
+						"With a zero Interval a large burst sends the flow with few scheduler events.",
+						UintegerValue (1),
+						MakeUintegerAccessor (&UdpClient::m_burst),
+						MakeUintegerChecker<uint32_t> (1))
 				.AddAttribute ("RemoteAddress",
 						"The destination Address of the outbound packets",
 						AddressValue (),
@@ -75,6 +88,40 @@ namespace ns3 {
 						UintegerValue (1),
 						MakeUintegerAccessor (&UdpClient::m_isHighEntropy),
 						MakeUintegerChecker<uint16_t> ())
+				.AddAttribute ("PayloadFile",
+						"File of ASCII bits read by high entropy payloads. When empty the bits "
+						"are drawn from the simulator RNG, so each RngRun sends different data.",
+						StringValue ("randomPayload.txt"),
+						MakeStringAccessor (&UdpClient::m_payloadFile),
+						MakeStringChecker ())
+				.AddAttribute ("LatencyTag",
+						"Tag every packet so the devices and the UdpServer record where its delay comes from.",
+						BooleanValue (false),
+						MakeBooleanAccessor (&UdpClient::m_latencyTag),
+						MakeBooleanChecker ())
+				.AddAttribute ("TraceFile",
+						"pcap or text (\"time size\" per line) trace to replay: each record is sent with its original "
+						"transport payload and size, at its original time offset. MaxPackets still applies. Empty to disable.",
+						StringValue (""),
+						MakeStringAccessor (&UdpClient::m_traceFile),
+						MakeStringChecker ())
+				.AddAttribute ("TraceTimeScale",
+						"Factor applied to the gaps between trace records, 0.5 replays twice as fast, 0 back to back.",
+						DoubleValue (1.0),
+						MakeDoubleAccessor (&UdpClient::m_traceTimeScale),
+						MakeDoubleChecker<double> (0))
+				.AddAttribute ("Entropy",
+						"Payload entropy in bits per byte, 0 to 8: every byte is drawn uniformly from round(2^Entropy) "
+						"values. Negative to send the IsHighEntropy payloads instead (all '0' or ASCII bits, about 1 bit per byte).",
+						DoubleValue (-1.0),
+						MakeDoubleAccessor (&UdpClient::m_entropy),
+						MakeDoubleChecker<double> (-1.0, 8.0))
+				.AddAttribute ("EntropyPhases",
+						"Workload phases as bits:packets pairs, e.g. \"0:2000,8:2000,0:2000\". Packet n gets the entropy "
+						"of the phase it falls in, packets past the last phase keep its entropy. Overrides Entropy when set.",
+						StringValue (""),
+						MakeStringAccessor (&UdpClient::m_phaseSchedule),
+						MakeStringChecker ())
 				.AddAttribute ("PacketSize",
 						"Size of packets generated. The minimum packet size is 12 bytes which is the size of the header carrying the sequence number and the time stamp.",
 						UintegerValue (1024),
@@ -89,7 +136,17 @@ namespace ns3 {
 		NS_LOG_FUNCTION (this);
 		m_sent = 0;
 		m_socket = 0;
+		m_traceValid = false;
 		m_sendEvent = EventId ();
+		m_payloadRng = CreateObject<UniformRandomVariable> ();
+	}
+
+	int64_t
+	UdpClient::AssignStreams (int64_t stream)
+	{
+		NS_LOG_FUNCTION (this << stream);
+		m_payloadRng->SetStream (stream);
+		return 1;
 	}
 
 	UdpClient::~UdpClient ()
@@ -173,6 +230,38 @@ namespace ns3 {
 
 		m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 		m_socket->SetAllowBroadcast (true);
+
+		std::stringstream peerAddressStringStream;
+		if (Ipv4Address::IsMatchingType (m_peerAddress))
+		{
+			peerAddressStringStream << Ipv4Address::ConvertFrom (m_peerAddress);
+		}
+		else if (Ipv6Address::IsMatchingType (m_peerAddress))
+		{
+			peerAddressStringStream << Ipv6Address::ConvertFrom (m_peerAddress);
+		}
+		m_peerAddressString = peerAddressStringStream.str ();
+
+		// payloads are streamed, memory does not grow with MaxPackets
+		m_zeroPayload.assign (GetPayloadSize (), '0');
+		m_payload.assign (GetPayloadSize (), '0');
+		ParsePhases ();
+
+		// only Send without an entropy dial reads the file, a trace replay never does
+		bool fromFile = m_isHighEntropy == 1 && m_traceFile.empty () && m_phases.empty () && m_entropy < 0;
+		if (fromFile && !m_payloadFile.empty () && !m_payloadStream.is_open ())
+		{
+			m_payloadStream.open (m_payloadFile.c_str (), std::ifstream::binary);
+			NS_ABORT_MSG_IF (!m_payloadStream, "UdpClient: cannot open " << m_payloadFile);
+		}
+
+		if (!m_traceFile.empty ())
+		{
+			m_trace.Open (m_traceFile);
+			m_traceValid = m_trace.Next (m_traceRecord);
+			m_sendEvent = Simulator::Schedule (Seconds (0.0), &UdpClient::SendTrace, this);
+			return;
+		}
 		m_sendEvent = Simulator::Schedule (Seconds (0.0), &UdpClient::Send, this);
 	}
 
@@ -181,6 +270,19 @@ namespace ns3 {
 	{
 		NS_LOG_FUNCTION (this);
 		Simulator::Cancel (m_sendEvent);
+		if (m_payloadStream.is_open ())
+		{
+			m_payloadStream.close ();
+		}
+		m_trace.Close ();
+		m_traceValid = false;
+	}
+
+	uint32_t
+	UdpClient::GetPayloadSize (void) const
+	{
+		SeqTsHeader seqTs;
+		return m_size - seqTs.GetSerializedSize ();
 	}
 
 	void
@@ -190,52 +292,147 @@ namespace ns3 {
 		NS_ASSERT (m_sendEvent.IsExpired ());
 
 		// idli 
-		std::string payload;
 		//counter = counter +1; //increasing counter
 
-		if(m_isHighEntropy == 0) { //for less than 6000  //idli1
-			//creating all 0s payload
-			for(int n = 0; n<1100; n++) { //1100 range
-				payload += std::to_string(0);      
+		for (uint32_t i = 0; i < m_burst && m_sent < m_count; i++) {
+			double entropy = GetEntropy (m_sent);
+			if (entropy >= 0) {
+				SendHelper(readEntropyPayload(entropy));
+			} else if (m_isHighEntropy == 1) { //idli1
+				SendHelper(readRandomPayload());
+			} else {
+				//all 0s payload
+				SendHelper(m_zeroPayload);
 			}
-		} 
-
-		if (m_isHighEntropy == 1) { //for greater than 6000 //idli1
-			payload = readRandomPayload();
 		}
 
-		SendHelper(payload);
+		if (m_sent < m_count)
+		{
+			m_sendEvent = Simulator::Schedule (m_interval, &UdpClient::Send, this);
+		}
 
 	} //send
 
-	std::string
+	void
+	UdpClient::SendTrace (void)
+	{
+		NS_LOG_FUNCTION (this);
+		NS_ASSERT (m_sendEvent.IsExpired ());
+
+		// the record is only read ahead once, the mapped trace is never copied
+		Time at = m_traceRecord.time;
+		while (m_traceValid && m_sent < m_count && m_traceRecord.time == at)
+		{
+			SendHelper (readTracePayload (m_traceRecord));
+			m_traceValid = m_trace.Next (m_traceRecord);
+		}
+
+		if (m_traceValid && m_sent < m_count)
+		{
+			int64_t gap = (m_traceRecord.time - at).GetNanoSeconds ();
+			m_sendEvent = Simulator::Schedule (NanoSeconds (static_cast<int64_t> (std::max<int64_t> (gap, 0) * m_traceTimeScale)),
+					&UdpClient::SendTrace, this);
+		}
+	}
+
+	const std::string &
+	UdpClient::readTracePayload (const TraceReader::Record &record)
+	{
+		SeqTsHeader seqTs;
+		uint32_t size = std::min<uint32_t> (record.size, 65507 - seqTs.GetSerializedSize ());
+		uint32_t captured = std::min (record.captured, size);
+		m_payload.assign (captured ? reinterpret_cast<const char *> (record.payload) : "", captured);
+		m_payload.resize (size, '0');
+		if (m_isHighEntropy == 1) {
+			for (uint32_t i = captured; i < size; i++) {
+				m_payload[i] = '0' + m_payloadRng->GetInteger (0, 1);
+			}
+		}
+		return m_payload;
+	}
+
+	void
+	UdpClient::ParsePhases (void)
+	{
+		m_phases.clear ();
+		std::istringstream iss (m_phaseSchedule);
+		std::string item;
+		while (std::getline (iss, item, ',')) {
+			std::istringstream phase (item);
+			double bits;
+			char colon;
+			uint32_t packets;
+			NS_ABORT_MSG_IF (!(phase >> bits >> colon >> packets) || colon != ':' || bits < 0 || bits > 8,
+					"UdpClient: bad EntropyPhases entry \"" << item << "\", expected bits:packets with bits 0 to 8");
+			m_phases.push_back (std::make_pair (bits, packets));
+		}
+	}
+
+	double
+	UdpClient::GetEntropy (uint32_t seq) const
+	{
+		if (m_phases.empty ()) {
+			return m_entropy;
+		}
+		uint64_t end = 0;
+		for (size_t i = 0; i < m_phases.size (); i++) {
+			end += m_phases[i].second;
+			if (seq < end) {
+				return m_phases[i].first;
+			}
+		}
+		return m_phases.back ().first;
+	}
+
+	const std::string &
+	UdpClient::readEntropyPayload (double bits)
+	{
+		uint32_t values = static_cast<uint32_t> (std::floor (std::pow (2.0, bits) + 0.5));
+		if (values <= 1) {
+			return m_zeroPayload;
+		}
+		m_payload.resize (GetPayloadSize ());
+		for (uint32_t i = 0; i < m_payload.size (); i++) {
+			m_payload[i] = static_cast<char> (m_payloadRng->GetInteger (0, values - 1));
+		}
+		return m_payload;
+	}
+
+	// Next PacketSize - 12 bits of PayloadFile, wrapping around at its end
+	// so the file can be shorter than the flow, or of the RNG without a file
+	const std::string &
 	UdpClient::readRandomPayload() {
- 
-		char *buffer = NULL;
-		unsigned int length = 1100;
-		std::ifstream is ("randomPayload.txt", std::ifstream::binary);
-		if (is) {
-			// get length of file:
-			is.seekg (payloadStartPosition, is.beg);
-			payloadStartPosition += 1100;
-			
-			// allocate memory:
-			buffer = new char [length];
-
-			// read data as a block:
-			is.read (buffer,length);
-
-			is.close();
+
+		uint32_t length = GetPayloadSize ();
+		m_payload.resize (length);
+
+		if (m_payloadFile.empty ()) {
+			for (uint32_t i = 0; i < length; i++) {
+				m_payload[i] = '0' + m_payloadRng->GetInteger (0, 1);
+			}
+			return m_payload;
 		}
-		std::string s(buffer, length);
-		delete (buffer);
 
-		return s;  
+		uint32_t done = 0;
+		bool rewound = false;
+		while (done < length) {
+			m_payloadStream.read (&m_payload[done], length - done);
+			std::streamsize n = m_payloadStream.gcount ();
+			done += n;
+			if (done < length) {
+				NS_ABORT_MSG_IF (n == 0 && rewound, "UdpClient: " << m_payloadFile << " is empty");
+				m_payloadStream.clear ();
+				m_payloadStream.seekg (0, m_payloadStream.beg);
+				rewound = true;
+			}
+		}
+
+		return m_payload;  
 	} //readRandomPayload
 
 
 	void
-	UdpClient::SendHelper (std::string payload) {
+	UdpClient::SendHelper (const std::string &payload) {
 
 
 		SeqTsHeader seqTs;
@@ -247,21 +444,18 @@ namespace ns3 {
 
 		p->AddHeader (seqTs);
 
-		std::stringstream peerAddressStringStream;
-		if (Ipv4Address::IsMatchingType (m_peerAddress))
+		if (m_latencyTag)
 		{
-			peerAddressStringStream << Ipv4Address::ConvertFrom (m_peerAddress);
-		}
-		else if (Ipv6Address::IsMatchingType (m_peerAddress))
-		{
-			peerAddressStringStream << Ipv6Address::ConvertFrom (m_peerAddress);
+			LatencyTag tag;
+			tag.Start (Simulator::Now ());
+			p->AddPacketTag (tag);
 		}
 
 		if ((m_socket->Send (p)) >= 0)
 		{
 			++m_sent;
 			NS_LOG_INFO ("TraceDelay TX " << m_size << " bytes to "
-					<< peerAddressStringStream.str () << " Uid: "
+					<< m_peerAddressString << " Uid: "
 					<< p->GetUid () << " Time: "
 					<< (Simulator::Now ()).GetSeconds ());
 
@@ -269,12 +463,7 @@ namespace ns3 {
 		else
 		{
 			NS_LOG_INFO ("Error while sending " << m_size << " bytes to "
-					<< peerAddressStringStream.str ());
-		}
-
-		if (m_sent < m_count)
-		{
-			m_sendEvent = Simulator::Schedule (m_interval, &UdpClient::Send, this);
+					<< m_peerAddressString);
 		}
 
 	} //sendhelper
@@ -27,6 +27,11 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "trace-reader.h"
+#include <fstream>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -48,11 +53,10 @@ public:
 //idli
 
    //uint32_t counter = 1;
-   int    payloadStartPosition = 0;   
    bool isHighEntropy = false; // for entropy
    int m_isHighEntropy; // for entropy
 
-   std::string readRandomPayload(void);
+   const std::string & readRandomPayload(void);
    void setIsHighEntropy (bool he);
 
 //idli
@@ -80,6 +84,15 @@ public:
    */
   void SetRemote (Address addr);
 
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
 protected:
   virtual void DoDispose (void);
 
@@ -89,21 +102,76 @@ private:
   virtual void StopApplication (void);
 
   /**
-   * \brief Send a packet
+   * \brief Send a burst of packets and schedule the next one
    */
   void Send (void);
 
-   void SendHelper (std::string payload); //idli
+   void SendHelper (const std::string &payload); //idli
+
+  /**
+   * \return the payload bytes after the SeqTsHeader
+   */
+  uint32_t GetPayloadSize (void) const;
+
+  /**
+   * \brief Send the current trace record and those at the same time, then
+   * schedule the next one after the scaled trace gap
+   */
+  void SendTrace (void);
+
+  /**
+   * \brief Payload of a trace record: its captured bytes, then filler up to
+   * its original size as a low or high entropy payload would have
+   * \param record the record
+   * \return the payload
+   */
+  const std::string & readTracePayload (const TraceReader::Record &record);
+
+  /**
+   * \brief Parse EntropyPhases, aborting on a malformed schedule
+   */
+  void ParsePhases (void);
+
+  /**
+   * \param seq a sequence number
+   * \return the payload entropy of that packet in bits per byte, -1 for the
+   * IsHighEntropy payloads
+   */
+  double GetEntropy (uint32_t seq) const;
+
+  /**
+   * \brief Payload whose bytes are drawn uniformly from round(2^bits) values
+   * \param bits the entropy in bits per byte, 0 to 8
+   * \return the payload
+   */
+  const std::string & readEntropyPayload (double bits);
 
   uint32_t m_count; //!< Maximum number of packets the application will send
   Time m_interval; //!< Packet inter-send time
   uint32_t m_size; //!< Size of the sent packet (including the SeqTsHeader)
+  uint32_t m_burst; //!< Packets sent per Send event
 
   uint32_t m_sent; //!< Counter for sent packets
   Ptr<Socket> m_socket; //!< Socket
   Address m_peerAddress; //!< Remote peer address
+  std::string m_peerAddressString; //!< Remote peer address for logging, set at start
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
+  std::string m_payloadFile; //!< High entropy payload file, empty to draw bits from m_payloadRng
+  bool m_latencyTag;         //!< Tag every packet with a LatencyTag
+  Ptr<UniformRandomVariable> m_payloadRng; //!< Source of high entropy bits without a file
+  std::ifstream m_payloadStream; //!< PayloadFile, read sequentially and rewound at its end
+  std::string m_payload;         //!< Payload of the packet being built, reused
+  std::string m_zeroPayload;     //!< Low entropy payload, built once per run
+  std::string m_traceFile;       //!< pcap or text trace replayed instead of generated payloads
+  double m_traceTimeScale;       //!< Factor applied to the trace inter-packet gaps
+  TraceReader m_trace;           //!< Mapped m_traceFile
+  TraceReader::Record m_traceRecord; //!< Next record to send
+  bool m_traceValid;             //!< m_traceRecord holds a record
+  double m_entropy;              //!< Payload entropy in bits per byte, negative to use IsHighEntropy
+  std::string m_phaseSchedule;   //!< EntropyPhases as set
+  /// Parsed schedule: entropy in bits per byte and packets, in order
+  std::vector<std::pair<double, uint32_t> > m_phases;
   
  
   
@@ -29,14 +29,17 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
-#include "packet-loss-counter.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
 
 #include "seq-ts-header.h"
 #include "udp-server.h"
+#include "latency-tag.h"
 
 #include <fstream>
 #include <unistd.h>
 #include <cmath>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -62,11 +65,32 @@ namespace ns3 {
 						MakeUintegerAccessor (&UdpServer::m_isHighEntropy),
 						MakeUintegerChecker<uint16_t> ())
 				.AddAttribute ("PacketWindowSize",
-						"The size of the window used to compute the packet loss. This value should be a multiple of 8.",
-						UintegerValue (32),
+						"The number of sequence numbers, one bit each, tracked to compute packet loss and reordering. Rounded up to a multiple of 64.",
+						UintegerValue (65536),
 						MakeUintegerAccessor (&UdpServer::GetPacketWindowSize,
 								&UdpServer::SetPacketWindowSize),
-						MakeUintegerChecker<uint16_t> (8,256))
+						MakeUintegerChecker<uint32_t> (64,1u << 28))
+				.AddAttribute ("HistogramPrecision",
+						"Significant bits kept by the delay and inter-arrival histograms (7 is better than 1%).",
+						UintegerValue (7),
+						MakeUintegerAccessor (&UdpServer::SetHistogramPrecision,
+								&UdpServer::GetHistogramPrecision),
+						MakeUintegerChecker<uint32_t> (1,16))
+				.AddAttribute ("StatsFile",
+						"File the delay and inter-arrival statistics are appended to when the application stops. Empty to disable.",
+						StringValue (""),
+						MakeStringAccessor (&UdpServer::m_statsFile),
+						MakeStringChecker ())
+				.AddAttribute ("FlowStats",
+						"Keep statistics per source address and port, for servers shared by several clients.",
+						BooleanValue (false),
+						MakeBooleanAccessor (&UdpServer::m_flowStats),
+						MakeBooleanChecker ())
+				.AddAttribute ("FlowWindow",
+						"The number of sequence numbers tracked per flow to compute its loss.",
+						UintegerValue (1024),
+						MakeUintegerAccessor (&UdpServer::m_flowWindow),
+						MakeUintegerChecker<uint32_t> (64,1u << 28))
 				.AddTraceSource ("Rx", "A packet has been received",
 						MakeTraceSourceAccessor (&UdpServer::m_rxTrace),
 						"ns3::Packet::TracedCallback")
@@ -78,7 +102,6 @@ namespace ns3 {
 	}
 
 	UdpServer::UdpServer ()
-	: m_lossCounter (0)
 	{
 		NS_LOG_FUNCTION (this);
 		m_received=0;
@@ -90,18 +113,30 @@ namespace ns3 {
 	}
 
 
-	uint16_t
+	uint32_t
 	UdpServer::GetPacketWindowSize () const
 	{
 		NS_LOG_FUNCTION (this);
-		return m_lossCounter.GetBitMapSize ();
+		return m_lossCounter.GetWindow ();
 	}
 
 	void
-	UdpServer::SetPacketWindowSize (uint16_t size)
+	UdpServer::SetPacketWindowSize (uint32_t size)
 	{
 		NS_LOG_FUNCTION (this << size);
-		m_lossCounter.SetBitMapSize (size);
+		m_lossCounter.SetWindow (size);
+	}
+
+	uint64_t
+	UdpServer::GetReordered (void) const
+	{
+		return m_lossCounter.GetReordered ();
+	}
+
+	uint64_t
+	UdpServer::GetDuplicates (void) const
+	{
+		return m_lossCounter.GetDuplicates ();
 	}
 
 	uint32_t
@@ -170,30 +205,149 @@ namespace ns3 {
 			m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
 		}
 
-		//idli
-		deltaTime = endTime - startTime;
+		if (!m_statsFile.empty () && m_delay.GetCount () > 0)
+		{
+			std::ofstream stats (m_statsFile.c_str (), std::ofstream::out | std::ofstream::app);
+			PrintStats (stats, "delay", m_delay);
+			PrintStats (stats, "interarrival", m_interArrival);
+			stats << "sequence " << m_received << " " << m_lossCounter.GetLost ()
+					<< " " << m_lossCounter.GetReordered () << " " << m_lossCounter.GetDuplicates () << std::endl;
+		}
 
-		std::ofstream ofs;
-		ofs.open ("Results.txt", std::ofstream::out | std::ofstream::app);
+		if (m_latency[0].GetCount () > 0)
+		{
+			std::ofstream lat ("Latency.txt", std::ofstream::out | std::ofstream::app);
+			for (int c = 0; c < LatencyTag::N_COMPONENTS; c++)
+			{
+				PrintStats (lat, LatencyTag::GetComponentName (LatencyTag::Component (c)), m_latency[c]);
+			}
+		}
 
-		ofs << "Simulation "<< " time diff :: "<<deltaTime.GetMilliSeconds() << " = "<< endTime.GetMilliSeconds() << " - "<< startTime.GetMilliSeconds() <<"          "<<std::endl;
+	}
 
-		ofs.close();
-		//idli
+	void
+	UdpServer::LogArrival (Time now)
+	{
+		if (m_received == 0)
+		{
+			startTime = now;
+		}
+		endTime = now;
+		deltaTime = endTime - startTime;
+	}
 
+	Time
+	UdpServer::GetLatencyMean (LatencyTag::Component c) const
+	{
+		return NanoSeconds (static_cast<int64_t> (m_latency[c].GetMean ()));
+	}
+
+	const HdrHistogram &
+	UdpServer::GetDelayHistogram (void) const
+	{
+		return m_delay;
+	}
+
+	const HdrHistogram &
+	UdpServer::GetInterArrivalHistogram (void) const
+	{
+		return m_interArrival;
 	}
 
 	void
-	UdpServer::logTime(int seqNo, Time seqTS) {
+	UdpServer::SetHistogramPrecision (uint32_t precision)
+	{
+		NS_LOG_FUNCTION (this << precision);
+		m_delay.Reset (precision);
+		m_interArrival.Reset (precision);
+		for (int c = 0; c < LatencyTag::N_COMPONENTS; c++)
+		{
+			m_latency[c].Reset (precision);
+		}
+	}
 
-		if(seqNo == 0) {
-			startTime = seqTS;
+	uint32_t
+	UdpServer::GetHistogramPrecision (void) const
+	{
+		return m_delay.GetPrecision ();
+	}
+
+	const UdpServer::FlowMap &
+	UdpServer::GetFlows (void) const
+	{
+		return m_flows;
+	}
+
+	uint64_t
+	UdpServer::GetFlowKey (const Address &from)
+	{
+		if (InetSocketAddress::IsMatchingType (from))
+		{
+			InetSocketAddress a = InetSocketAddress::ConvertFrom (from);
+			return (static_cast<uint64_t> (a.GetIpv4 ().Get ()) << 16) | a.GetPort ();
 		}
+		Inet6SocketAddress a = Inet6SocketAddress::ConvertFrom (from);
+		uint8_t bytes[16];
+		a.GetIpv6 ().GetBytes (bytes);
+		uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+		for (int i = 0; i < 16; i++)
+		{
+			hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+		}
+		hash = (hash ^ a.GetPort ()) * 0x100000001b3ULL;
+		return hash | (1ULL << 63);
+	}
 
-		if(seqNo == 5999) {
-			endTime = seqTS;
+	void
+	UdpServer::LogFlow (const Address &from, uint32_t seq, uint32_t size, Time delay)
+	{
+		FlowMap::iterator it = m_flows.find (GetFlowKey (from));
+		if (it == m_flows.end ())
+		{
+			FlowStats flow;
+			flow.from = from;
+			flow.received = 0;
+			flow.bytes = 0;
+			flow.firstArrival = Simulator::Now ();
+			flow.sequence.SetWindow (m_flowWindow);
+			it = m_flows.insert (std::make_pair (GetFlowKey (from), flow)).first;
 		}
+		FlowStats &flow = it->second;
+		flow.received++;
+		flow.bytes += size;
+		flow.lastArrival = Simulator::Now ();
+		flow.delaySum += delay;
+		flow.delayMax = std::max (flow.delayMax, delay);
+		flow.sequence.NotifyReceived (flow.sequence.Unwrap (seq));
+	}
+
+	// name, count, then mean, stddev, min, p50, p90, p99, p99.9 and max in us
+	void
+	UdpServer::PrintStats (std::ostream &os, const std::string &name, const HdrHistogram &h)
+	{
+		os << name << " " << h.GetCount ()
+				<< " " << h.GetMean () / 1000 << " " << h.GetStdDev () / 1000
+				<< " " << h.GetMin () / 1000.0
+				<< " " << h.GetPercentile (0.5) / 1000.0
+				<< " " << h.GetPercentile (0.9) / 1000.0
+				<< " " << h.GetPercentile (0.99) / 1000.0
+				<< " " << h.GetPercentile (0.999) / 1000.0
+				<< " " << h.GetMax () / 1000.0 << std::endl;
+	}
 
+	void
+	UdpServer::LogLatency (Ptr<Packet> packet)
+	{
+		LatencyTag tag;
+		if (!packet->PeekPacketTag (tag))
+		{
+			return;
+		}
+		tag.Stamp (LatencyTag::STACK, Simulator::Now ());
+		for (int c = 0; c < LatencyTag::N_COMPONENTS; c++)
+		{
+			m_latency[c].Record (tag.Get (LatencyTag::Component (c)).GetNanoSeconds ());
+		}
 	}
 
 	void
@@ -212,25 +366,14 @@ namespace ns3 {
 			if (packet->GetSize () > 0)
 			{
 
+				uint32_t size = packet->GetSize ();
 				SeqTsHeader seqTs;
 				packet->RemoveHeader (seqTs);
 
-				// idli
-
-				//counter += 1;
-
-				uint8_t *buffer = new uint8_t[packet->GetSize ()];
-				packet->CopyData(buffer, packet->GetSize ());
-				std::string data = std::string(buffer, buffer+packet->GetSize());
-				
-				//idli
-
 				uint32_t currentSequenceNumber = seqTs.GetSeq ();
 
-				Time now; //idli
 				if (InetSocketAddress::IsMatchingType (from))
 				{
-					now  = Simulator::Now ();
 					NS_LOG_INFO ("TraceDelay: RX " << packet->GetSize () <<
 							" bytes from "<< InetSocketAddress::ConvertFrom (from).GetIpv4 () <<
 							" Sequence Number: " << currentSequenceNumber <<
@@ -250,11 +393,22 @@ namespace ns3 {
 							" Delay: " << Simulator::Now () - seqTs.GetTs ());
 				}
 
-				m_lossCounter.NotifyReceived (currentSequenceNumber);
+				Time now = Simulator::Now ();
+				m_delay.Record ((now - seqTs.GetTs ()).GetNanoSeconds ());
+				if (m_received > 0)
+				{
+					m_interArrival.Record ((now - m_lastArrival).GetNanoSeconds ());
+				}
+				m_lastArrival = now;
+				if (m_flowStats)
+				{
+					LogFlow (from, currentSequenceNumber, size, now - seqTs.GetTs ());
+				}
+
+				LogArrival (now);
+				LogLatency (packet);
+				m_lossCounter.NotifyReceived (m_lossCounter.Unwrap (currentSequenceNumber));
 				m_received++;
-				//idli
-				logTime(currentSequenceNumber, now);
-				//idli
 			}
 		}
 
@@ -28,7 +28,11 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
-#include "packet-loss-counter.h"
+#include "sequence-tracker.h"
+#include "latency-tag.h"
+#include "hdr-histogram.h"
+#include <string>
+#include <unordered_map>
 
 namespace ns3 {
 /**
@@ -54,11 +58,9 @@ public:
    //int counter = 1;
    int m_isHighEntropy;
 
-   Time deltaTime;
-   Time startTime;    
-   Time endTime;        
-
-   void logTime(int, Time);
+   Time deltaTime;   //!< Time between the first and the last arrival
+   Time startTime;   //!< Time of the first arrival
+   Time endTime;     //!< Time of the last arrival
 
    //idli
 
@@ -86,19 +88,94 @@ public:
    */
   uint64_t GetReceived (void) const;
 
+  /**
+   * \brief Returns the number of packets received after a higher sequence number
+   * \return the number of reordered packets
+   */
+  uint64_t GetReordered (void) const;
+
+  /**
+   * \brief Returns the number of packets whose sequence number was already received
+   * \return the number of duplicate packets
+   */
+  uint64_t GetDuplicates (void) const;
+
   /**
    * \brief Returns the size of the window used for checking loss.
    * \return the size of the window used for checking loss.
    */
-  uint16_t GetPacketWindowSize () const;
+  uint32_t GetPacketWindowSize () const;
+
+  /**
+   * \brief Set the size of the window used for checking loss, rounded up
+   *  to a multiple of 64
+   * \param size the number of sequence numbers tracked, one bit each
+   */
+  void SetPacketWindowSize (uint32_t size);
 
   /**
-   * \brief Set the size of the window used for checking loss. This value should
-   *  be a multiple of 8
-   * \param size the size of the window used for checking loss. This value should
-   *  be a multiple of 8
+   * \brief Returns the mean delay charged to a component by LatencyTag
+   * \param c the component
+   * \return the mean over the tagged packets received, zero if none
    */
-  void SetPacketWindowSize (uint16_t size);
+  Time GetLatencyMean (LatencyTag::Component c) const;
+
+  /**
+   * \brief Returns the one-way delay distribution, in nanoseconds
+   * \return the histogram of send to receive delays
+   */
+  const HdrHistogram & GetDelayHistogram (void) const;
+
+  /**
+   * \brief Returns the inter-arrival time distribution, in nanoseconds
+   * \return the histogram of gaps between consecutive arrivals
+   */
+  const HdrHistogram & GetInterArrivalHistogram (void) const;
+
+  /**
+   * \brief Set the significant bits kept by the histograms, clearing them
+   * \param precision the number of significant bits (1-16)
+   */
+  void SetHistogramPrecision (uint32_t precision);
+
+  /**
+   * \brief Get the significant bits kept by the histograms
+   * \return the number of significant bits
+   */
+  uint32_t GetHistogramPrecision (void) const;
+
+  /// Statistics of the packets received from one source address and port
+  struct FlowStats
+  {
+    Address from;              //!< Source address and port
+    uint64_t received;         //!< Packets received
+    uint64_t bytes;            //!< Bytes received, SeqTsHeader included
+    Time firstArrival;         //!< Time of the first arrival
+    Time lastArrival;          //!< Time of the last arrival
+    Time delaySum;             //!< Total one-way delay
+    Time delayMax;             //!< Largest one-way delay
+    SequenceTracker sequence;  //!< Loss and reordering of the flow
+  };
+
+  /// Flows by GetFlowKey of their source
+  typedef std::unordered_map<uint64_t, FlowStats> FlowMap;
+
+  /**
+   * \brief Returns the per-flow statistics, empty unless FlowStats is set
+   * \return the flows seen so far
+   */
+  const FlowMap & GetFlows (void) const;
+
+  /**
+   * \brief Returns the key of a source in the flow map
+   *
+   * An IPv4 source maps to its address and port; an IPv6 one to a hash
+   * of them with the top bit set, so the two never collide.
+   *
+   * \param from an InetSocketAddress or Inet6SocketAddress
+   * \return the key
+   */
+  static uint64_t GetFlowKey (const Address &from);
 protected:
   virtual void DoDispose (void);
 
@@ -120,7 +197,48 @@ private:
   Ptr<Socket> m_socket; //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
   uint64_t m_received; //!< Number of received packets
-  PacketLossCounter m_lossCounter; //!< Lost packet counter
+
+  /**
+   * \brief Update the arrival dispersion with a new arrival
+   * \param now the arrival time
+   */
+  void LogArrival (Time now);
+
+  /**
+   * \brief Add the delay breakdown of a packet carrying a LatencyTag
+   * \param packet the received packet
+   */
+  void LogLatency (Ptr<Packet> packet);
+
+  /**
+   * \brief Append the statistics of a histogram of nanoseconds to a stream
+   * \param os the stream
+   * \param name the first column
+   * \param h the histogram
+   */
+  static void PrintStats (std::ostream &os, const std::string &name, const HdrHistogram &h);
+
+  HdrHistogram m_delay;        //!< One-way delay in ns
+  HdrHistogram m_interArrival; //!< Gap between consecutive arrivals in ns
+  Time m_lastArrival;          //!< Time of the previous arrival
+  std::string m_statsFile;     //!< File the statistics are appended to, empty for none
+
+  /// Delay per component in ns, for packets received with a LatencyTag
+  HdrHistogram m_latency[LatencyTag::N_COMPONENTS];
+  SequenceTracker m_lossCounter; //!< Lost, reordered and duplicate packet counter
+
+  /**
+   * \brief Update the statistics of the flow a packet belongs to
+   * \param from the source of the packet
+   * \param seq its sequence number
+   * \param size its size, SeqTsHeader included
+   * \param delay its one-way delay
+   */
+  void LogFlow (const Address &from, uint32_t seq, uint32_t size, Time delay);
+
+  bool m_flowStats;     //!< Keep per-flow statistics
+  uint32_t m_flowWindow; //!< Sequence window of each flow
+  FlowMap m_flows;      //!< Per-flow statistics
 
   /// Callbacks for tracing the packet Rx events
   TracedCallback<Ptr<const Packet> > m_rxTrace;
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/hdr-histogram.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \brief Values below 2^precision are kept exactly
+ */
+class HdrHistogramExactTestCase : public TestCase
+{
+public:
+  HdrHistogramExactTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HdrHistogramExactTestCase::HdrHistogramExactTestCase ()
+  : TestCase ("HdrHistogram exact range and statistics")
+{
+}
+
+void
+HdrHistogramExactTestCase::DoRun (void)
+{
+  HdrHistogram h (7);
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (0.5), 0, "empty histogram");
+  for (uint64_t v = 1; v <= 100; v++)
+    {
+      h.Record (v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 100, "count");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMin (), 1, "min");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMax (), 100, "max");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h.GetMean (), 50.5, 1e-9, "mean");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h.GetStdDev (), std::sqrt (100 * 101 / 12.0), 1e-9, "sample standard deviation");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (0.5), 50, "median of 1..100");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (0.99), 99, "99th percentile of 1..100");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (0), 1, "0th percentile is the minimum");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (1), 100, "100th percentile is the maximum");
+
+  h.Reset (3);
+  NS_TEST_ASSERT_MSG_EQ (h.GetCount (), 0, "Reset drops the values");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPrecision (), 3, "Reset changes the precision");
+}
+
+/**
+ * \ingroup applications-test
+ * \brief Log-linear buckets keep the relative error within 2^-precision
+ */
+class HdrHistogramBucketTestCase : public TestCase
+{
+public:
+  HdrHistogramBucketTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HdrHistogramBucketTestCase::HdrHistogramBucketTestCase ()
+  : TestCase ("HdrHistogram bucket precision")
+{
+}
+
+void
+HdrHistogramBucketTestCase::DoRun (void)
+{
+  const uint32_t precisions[] = {1, 4, 7, 16};
+  for (uint32_t p : precisions)
+    {
+      // a single value comes back as its bucket midpoint, clamped to min and max,
+      // so record it twice with neighbours that pin neither bound
+      for (uint32_t msb = 0; msb < 64; msb++)
+        {
+          const uint64_t offsets[] = {0, 1, 3};
+          for (uint64_t offset : offsets)
+            {
+              uint64_t v = (1ull << msb) + (offset << (msb / 2));
+              HdrHistogram h (p);
+              h.Record (0);
+              h.Record (v);
+              h.Record (v);
+              h.Record (std::numeric_limits<uint64_t>::max ());
+              double got = h.GetPercentile (0.5);
+              double error = std::fabs (got - double (v)) / double (v);
+              NS_TEST_ASSERT_MSG_LT (error, std::ldexp (1.0, -int (p)) + 1e-12,
+                                     "value " << v << " at precision " << p << " read back as " << got);
+            }
+        }
+    }
+
+  // bucket boundaries: 2^p is the first value that is not exact
+  HdrHistogram h (4);
+  for (uint64_t v = 0; v < 16; v++)
+    {
+      h.Record (v);
+    }
+  h.Record (16);
+  h.Record (17);
+  h.Record (1000);
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (15 / 19.0), 14, "values below 16 are exact");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (17 / 19.0), 16, "16 and 17 share a bucket two wide");
+  NS_TEST_ASSERT_MSG_EQ (h.GetPercentile (1), 991, "1000 reads back as the midpoint of [960, 1023]");
+  NS_TEST_ASSERT_MSG_EQ (h.GetMax (), 1000, "the maximum is exact");
+
+  // an ascending sequence keeps every percentile within the bound
+  HdrHistogram g (7);
+  std::vector<uint64_t> values;
+  for (uint64_t v = 1000; v < 1000000; v += 997)
+    {
+      values.push_back (v);
+      g.Record (v);
+    }
+  const double qs[] = {0.1, 0.5, 0.9, 0.99, 0.999};
+  for (double q : qs)
+    {
+      uint64_t rank = static_cast<uint64_t> (std::ceil (q * values.size ()));
+      double exact = values[rank - 1];
+      NS_TEST_EXPECT_MSG_LT (std::fabs (g.GetPercentile (q) - exact) / exact, 1.0 / 128 + 1e-12,
+                             "percentile " << q);
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \brief HdrHistogram test suite
+ */
+class HdrHistogramTestSuite : public TestSuite
+{
+public:
+  HdrHistogramTestSuite ();
+};
+
+HdrHistogramTestSuite::HdrHistogramTestSuite ()
+  : TestSuite ("hdr-histogram", UNIT)
+{
+  AddTestCase (new HdrHistogramExactTestCase (), TestCase::QUICK);
+  AddTestCase (new HdrHistogramBucketTestCase (), TestCase::QUICK);
+}
+
+static HdrHistogramTestSuite g_hdrHistogramTestSuite; //!< The test suite
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/results-sink.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \brief One header line however often a CSV file is appended to
+ */
+class ResultsSinkAppendTestCase : public TestCase
+{
+public:
+  ResultsSinkAppendTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param filename the CSV file
+   * \return the lines of the file
+   */
+  std::vector<std::string> ReadLines (const std::string &filename);
+};
+
+ResultsSinkAppendTestCase::ResultsSinkAppendTestCase ()
+  : TestCase ("ResultsSink header and append")
+{
+}
+
+std::vector<std::string>
+ResultsSinkAppendTestCase::ReadLines (const std::string &filename)
+{
+  std::vector<std::string> lines;
+  std::ifstream ifs (filename.c_str ());
+  std::string line;
+  while (std::getline (ifs, line))
+    {
+      lines.push_back (line);
+    }
+  return lines;
+}
+
+void
+ResultsSinkAppendTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("results-sink.csv");
+  std::remove (filename.c_str ());
+
+  std::vector<ResultsSink::Column> columns = {
+    {"rate_mbps", ResultsSink::REAL}, {"codec", ResultsSink::TEXT},
+    {"packets", ResultsSink::INTEGER}};
+
+  {
+    Ptr<ResultsSink> sink = Create<ResultsSink> (filename, columns, "", 2);
+    sink->Write (sink->NewRecord ().Set ("rate_mbps", 2.5).Set ("codec", std::string ("deflate")).Set ("packets", (int64_t) 6000));
+    NS_TEST_ASSERT_MSG_EQ (ReadLines (filename).size (), 0, "one row is still buffered");
+    sink->Write (sink->NewRecord ().Set ("rate_mbps", 3.0).Set ("codec", std::string ("a,\"b\"")));
+    NS_TEST_ASSERT_MSG_EQ (ReadLines (filename).size (), 3, "a full block writes the header and both rows");
+    sink->Write (sink->NewRecord ().Set ("packets", (int64_t) -1));
+    sink->Flush ();
+    NS_TEST_ASSERT_MSG_EQ (ReadLines (filename).size (), 4, "Flush writes the buffered row");
+    sink->Write (sink->NewRecord ().Set ("rate_mbps", 4.0));
+  }
+
+  // a second sink, as a restarted sweep, appends without a second header
+  {
+    Ptr<ResultsSink> sink = Create<ResultsSink> (filename, columns);
+    sink->Write (sink->NewRecord ().Set ("rate_mbps", 5.0));
+  }
+
+  std::vector<std::string> lines = ReadLines (filename);
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 6, "destroying a sink flushes it");
+  NS_TEST_EXPECT_MSG_EQ (lines[0], "rate_mbps,codec,packets", "header");
+  NS_TEST_EXPECT_MSG_EQ (lines[1], "2.5,deflate,6000", "first row");
+  NS_TEST_EXPECT_MSG_EQ (lines[2], "3,\"a,\"\"b\"\"\",0", "quoted text, unset integer");
+  NS_TEST_EXPECT_MSG_EQ (lines[3], "0,,-1", "unset real and text");
+  NS_TEST_EXPECT_MSG_EQ (lines[4], "4,,0", "row flushed by the destructor");
+  NS_TEST_EXPECT_MSG_EQ (lines[5], "5,,0", "row of the second sink");
+
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup applications-test
+ * \brief ResultsSink test suite
+ */
+class ResultsSinkTestSuite : public TestSuite
+{
+public:
+  ResultsSinkTestSuite ();
+};
+
+ResultsSinkTestSuite::ResultsSinkTestSuite ()
+  : TestSuite ("results-sink", UNIT)
+{
+  AddTestCase (new ResultsSinkAppendTestCase (), TestCase::QUICK);
+}
+
+static ResultsSinkTestSuite g_resultsSinkTestSuite; //!< The test suite
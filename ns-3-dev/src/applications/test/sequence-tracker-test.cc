@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/sequence-tracker.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \brief Accounting stays exact as the ring wraps around many times
+ */
+class SequenceTrackerRingTestCase : public TestCase
+{
+public:
+  SequenceTrackerRingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SequenceTrackerRingTestCase::SequenceTrackerRingTestCase ()
+  : TestCase ("SequenceTracker ring wraparound")
+{
+}
+
+void
+SequenceTrackerRingTestCase::DoRun (void)
+{
+  SequenceTracker tracker (100);
+  NS_TEST_ASSERT_MSG_EQ (tracker.GetWindow (), 128, "window rounded up to 64 bit words");
+
+  // every 10th sequence number lost, pairs swapped, over 80 windows
+  uint64_t lost = 0;
+  for (uint64_t seq = 0; seq < 10240; seq += 2)
+    {
+      uint64_t first = seq + 1;
+      uint64_t second = seq;
+      if (first % 10 != 0)
+        {
+          tracker.NotifyReceived (first);
+        }
+      else
+        {
+          lost++;
+        }
+      if (second % 10 != 0)
+        {
+          tracker.NotifyReceived (second);
+        }
+      else
+        {
+          lost++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLost (), lost, "lost");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetReordered (), 10240 / 2 - 1024, "reordered");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetMaxReorder (), 1, "max reorder");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetDuplicates (), 0, "duplicates");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLate (), 0, "late");
+
+  // a duplicate inside the window, then one that left it
+  tracker.NotifyReceived (10201);
+  tracker.NotifyReceived (10001);
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetDuplicates (), 1, "duplicate inside the window");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLate (), 1, "arrival behind the window");
+
+  // a jump of several windows loses everything in between at once
+  tracker.NotifyReceived (20000);
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLost (), lost + (20000 - 10240), "lost across a jump");
+  tracker.NotifyReceived (19990);
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLost (), lost + (20000 - 10240) - 1, "a late arrival inside the window is not lost");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetMaxReorder (), 10, "max reorder after the jump");
+}
+
+/**
+ * \ingroup applications-test
+ * \brief 32 bit sequence numbers carry on across their wraparound
+ */
+class SequenceTrackerUnwrapTestCase : public TestCase
+{
+public:
+  SequenceTrackerUnwrapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SequenceTrackerUnwrapTestCase::SequenceTrackerUnwrapTestCase ()
+  : TestCase ("SequenceTracker 32 bit wraparound")
+{
+}
+
+void
+SequenceTrackerUnwrapTestCase::DoRun (void)
+{
+  SequenceTracker tracker (256);
+  NS_TEST_ASSERT_MSG_EQ (tracker.Unwrap (7), 7, "before any arrival");
+
+  // start just below 2^32, lose one on each side of the wrap, reorder across it
+  const uint32_t seqs[] = {0xfffffff0u, 0xfffffff1u, 0xfffffff3u, 0xfffffffeu,
+                           0xffffffffu, 1, 0, 2, 4, 0xfffffffdu};
+  for (uint32_t seq : seqs)
+    {
+      tracker.NotifyReceived (tracker.Unwrap (seq));
+    }
+  NS_TEST_EXPECT_MSG_EQ (tracker.Unwrap (5), 0x100000005ull, "after the wrap");
+  NS_TEST_EXPECT_MSG_EQ (tracker.Unwrap (0xfffffff0u), 0xfffffff0ull, "behind the wrap");
+  // a flow starts at 0, so everything below the first arrival is lost;
+  // then 0xfffffff0-f1, f3, fd-ff, 0-2 and 4 out of the 21 from 0xfffffff0 to 4
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLost (), 0xfffffff0ull + 21 - 10, "lost");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetReordered (), 2, "reordered");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetMaxReorder (), 7, "max reorder across the wrap");
+  NS_TEST_EXPECT_MSG_EQ (tracker.GetLate (), 0, "nothing counted late");
+}
+
+/**
+ * \ingroup applications-test
+ * \brief SequenceTracker test suite
+ */
+class SequenceTrackerTestSuite : public TestSuite
+{
+public:
+  SequenceTrackerTestSuite ();
+};
+
+SequenceTrackerTestSuite::SequenceTrackerTestSuite ()
+  : TestSuite ("sequence-tracker", UNIT)
+{
+  AddTestCase (new SequenceTrackerRingTestCase (), TestCase::QUICK);
+  AddTestCase (new SequenceTrackerUnwrapTestCase (), TestCase::QUICK);
+}
+
+static SequenceTrackerTestSuite g_sequenceTrackerTestSuite; //!< The test suite
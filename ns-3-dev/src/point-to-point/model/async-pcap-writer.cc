@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/packet.h"
+#include "async-pcap-writer.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncPcapWriter");
+
+namespace {
+
+/// Append a value in host byte order, as readers detect it from the magic
+template <typename T>
+void
+Append (std::vector<uint8_t> &buffer, T value)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *> (&value);
+  buffer.insert (buffer.end (), bytes, bytes + sizeof (T));
+}
+
+} // anonymous namespace
+
+AsyncPcapWriter::AsyncPcapWriter (const std::string &filename, uint32_t dataLinkType,
+                                  uint32_t snapLen, bool gzip, uint32_t bufferSize,
+                                  uint32_t maxBuffers)
+  : m_filename (filename),
+    m_gzip (gzip),
+    m_file (0),
+    m_gzFile (0),
+    m_snapLen (snapLen),
+    m_bufferSize (std::max<uint32_t> (bufferSize, 4096)),
+    m_maxBuffers (std::max<uint32_t> (maxBuffers, 1)),
+    m_allocated (1),
+    m_closed (false),
+    m_stop (false),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << filename << dataLinkType << snapLen << gzip << bufferSize << maxBuffers);
+  if (m_gzip)
+    {
+      m_gzFile = gzopen (filename.c_str (), "wb1");
+      NS_ABORT_MSG_IF (m_gzFile == 0, "AsyncPcapWriter: cannot open " << filename);
+    }
+  else
+    {
+      m_file = std::fopen (filename.c_str (), "wb");
+      NS_ABORT_MSG_IF (m_file == 0, "AsyncPcapWriter: cannot open " << filename);
+    }
+
+  m_current.reserve (m_bufferSize);
+  Append<uint32_t> (m_current, 0xa1b2c3d4); // magic, microsecond timestamps
+  Append<uint16_t> (m_current, 2);          // version major
+  Append<uint16_t> (m_current, 4);          // version minor
+  Append<int32_t> (m_current, 0);           // time zone correction
+  Append<uint32_t> (m_current, 0);          // timestamp accuracy
+  Append<uint32_t> (m_current, m_snapLen);
+  Append<uint32_t> (m_current, dataLinkType);
+
+  m_thread = std::thread (&AsyncPcapWriter::WriterLoop, this);
+}
+
+AsyncPcapWriter::~AsyncPcapWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_closed)
+    {
+      NS_ABORT_MSG_IF (!Close (), "AsyncPcapWriter: cannot write " << m_filename);
+    }
+}
+
+uint32_t
+AsyncPcapWriter::GetBuffersAllocated (void) const
+{
+  return m_allocated;
+}
+
+void
+AsyncPcapWriter::Write (Time t, Ptr<const Packet> p)
+{
+  NS_ASSERT_MSG (!m_closed, "AsyncPcapWriter: write after Close");
+  uint32_t origLen = p->GetSize ();
+  uint32_t inclLen = std::min (origLen, m_snapLen);
+  if (m_current.size () + 16 + inclLen > m_bufferSize)
+    {
+      Flush ();
+    }
+
+  int64_t us = t.GetMicroSeconds ();
+  Append<uint32_t> (m_current, us / 1000000);
+  Append<uint32_t> (m_current, us % 1000000);
+  Append<uint32_t> (m_current, inclLen);
+  Append<uint32_t> (m_current, origLen);
+
+  std::size_t offset = m_current.size ();
+  m_current.resize (offset + inclLen);
+  p->CopyData (&m_current[offset], inclLen);
+}
+
+void
+AsyncPcapWriter::Flush (void)
+{
+  std::vector<uint8_t> next;
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    if (m_full.size () >= m_maxBuffers)
+      {
+        NS_LOG_LOGIC ("Writer behind, waiting for " << m_maxBuffers << " buffers");
+      }
+    while (m_full.size () >= m_maxBuffers)
+      {
+        m_drained.wait (lock);
+      }
+    m_full.push_back (std::move (m_current));
+    if (!m_free.empty ())
+      {
+        next = std::move (m_free.back ());
+        m_free.pop_back ();
+      }
+  }
+  m_wakeup.notify_one ();
+
+  if (next.capacity () == 0)
+    {
+      m_allocated++;
+      NS_LOG_LOGIC ("Writer behind, " << m_allocated << " buffers allocated");
+    }
+  next.clear ();
+  next.reserve (m_bufferSize);
+  m_current = std::move (next);
+}
+
+bool
+AsyncPcapWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return !m_failed;
+    }
+  m_closed = true;
+  if (!m_current.empty ())
+    {
+      Flush ();
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_wakeup.notify_one ();
+  m_thread.join ();
+
+  // both flush what the stream still buffers, so they can fail too
+  bool closed;
+  if (m_gzip)
+    {
+      closed = gzclose (m_gzFile) == Z_OK;
+      m_gzFile = 0;
+    }
+  else
+    {
+      closed = std::fclose (m_file) == 0;
+      m_file = 0;
+    }
+  if (!closed && !m_failed)
+    {
+      NS_LOG_WARN ("AsyncPcapWriter: cannot close " << m_filename);
+      m_failed = true;
+    }
+  return !m_failed;
+}
+
+void
+AsyncPcapWriter::WriterLoop (void)
+{
+  for (;;)
+    {
+      std::vector<uint8_t> buffer;
+      bool failed;
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        while (m_full.empty () && !m_stop)
+          {
+            m_wakeup.wait (lock);
+          }
+        if (m_full.empty ())
+          {
+            return;
+          }
+        buffer = std::move (m_full.front ());
+        m_full.pop_front ();
+        failed = m_failed;
+      }
+      m_drained.notify_one ();
+
+      // once a write has failed the file is missing records, so the rest
+      // is only drained, which keeps a blocked Flush from waiting forever
+      if (!failed)
+        {
+          std::size_t written;
+          if (m_gzip)
+            {
+              int ret = gzwrite (m_gzFile, buffer.data (), buffer.size ());
+              written = ret > 0 ? ret : 0;
+            }
+          else
+            {
+              written = std::fwrite (buffer.data (), 1, buffer.size (), m_file);
+            }
+          failed = written != buffer.size ();
+          if (failed)
+            {
+              NS_LOG_WARN ("AsyncPcapWriter: short write to " << m_filename);
+            }
+        }
+
+      buffer.clear ();
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_failed = failed;
+      m_free.push_back (std::move (buffer));
+    }
+}
+
+} // namespace ns3
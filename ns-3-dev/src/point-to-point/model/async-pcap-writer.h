@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_PCAP_WRITER_H
+#define ASYNC_PCAP_WRITER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <zlib.h>
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup point-to-point
+ * \brief Pcap file written from a background thread.
+ *
+ * Write only copies the record into an in-memory buffer.  Full buffers
+ * are handed to a writer thread, which stores them with one large
+ * sequential write each, optionally through gzip.  The simulator thread
+ * takes a lock once per buffer, never per packet.  When the writer falls
+ * behind, more buffers are allocated instead, until maxBuffers of them are
+ * waiting; only then does the simulator thread wait for the disk, so the
+ * memory held is bounded by about maxBuffers + 2 buffers.
+ *
+ * A write that fails, on the thread or when the file is closed, is
+ * reported by Close; the records after it are discarded.
+ *
+ * The file uses the classic pcap format with microsecond timestamps, like
+ * PcapFileWrapper.
+ */
+class AsyncPcapWriter : public SimpleRefCount<AsyncPcapWriter>
+{
+public:
+  /**
+   * \param filename the file to create
+   * \param dataLinkType the pcap data link type, e.g. 9 for PPP
+   * \param snapLen bytes of each packet kept in the file
+   * \param gzip compress the file with gzip
+   * \param bufferSize size of each in-memory buffer in bytes
+   * \param maxBuffers full buffers waiting for the writer before Write blocks
+   */
+  AsyncPcapWriter (const std::string &filename, uint32_t dataLinkType,
+                   uint32_t snapLen = 65535, bool gzip = false,
+                   uint32_t bufferSize = 4 << 20, uint32_t maxBuffers = 16);
+  ~AsyncPcapWriter ();
+
+  /**
+   * \brief Append one record
+   * \param t the record timestamp
+   * \param p the packet, truncated to the snap length
+   */
+  void Write (Time t, Ptr<const Packet> p);
+
+  /**
+   * \brief Write every buffered record, close the file and stop the thread
+   *
+   * Called by the destructor if needed, which aborts if it fails.
+   *
+   * \return false if any record could not be written; later calls return
+   *         the same
+   */
+  bool Close (void);
+
+  /**
+   * \return the number of buffers allocated because the writer thread
+   * had not yet returned a free one
+   */
+  uint32_t GetBuffersAllocated (void) const;
+
+private:
+  AsyncPcapWriter (const AsyncPcapWriter &);
+  AsyncPcapWriter & operator = (const AsyncPcapWriter &);
+
+  /**
+   * \brief Queue the current buffer for writing and take a free one
+   */
+  void Flush (void);
+  void WriterLoop (void);
+
+  std::string m_filename;          //!< Output file
+  bool m_gzip;                     //!< Compress with gzip
+  std::FILE *m_file;               //!< Output stream without gzip
+  gzFile m_gzFile;                 //!< Output stream with gzip
+  uint32_t m_snapLen;              //!< Bytes kept per packet
+  uint32_t m_bufferSize;           //!< Size of each buffer
+  uint32_t m_maxBuffers;           //!< Bound on m_full
+  std::vector<uint8_t> m_current;  //!< Buffer being filled
+  std::deque<std::vector<uint8_t> > m_full; //!< Buffers waiting for the writer
+  std::vector<std::vector<uint8_t> > m_free; //!< Written buffers ready for reuse
+  uint32_t m_allocated;            //!< Buffers allocated so far
+  bool m_closed;                   //!< Close has run
+  bool m_stop;                     //!< Writer thread must exit once m_full is empty
+  bool m_failed;                   //!< A write failed, later buffers are discarded
+  std::mutex m_mutex;              //!< Protects m_full, m_free, m_stop and m_failed
+  std::condition_variable m_wakeup; //!< Signalled when m_full grows or m_stop is set
+  std::condition_variable m_drained; //!< Signalled when m_full shrinks
+  std::thread m_thread;            //!< Writer thread
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_PCAP_WRITER_H */
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "compressed-transit-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressedTransitTag");
+
+NS_OBJECT_ENSURE_REGISTERED (CompressedTransitTag);
+
+TypeId
+CompressedTransitTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CompressedTransitTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<CompressedTransitTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+CompressedTransitTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+CompressedTransitTag::CompressedTransitTag ()
+  : m_hops (0)
+{
+}
+
+uint32_t
+CompressedTransitTag::GetSerializedSize (void) const
+{
+  return 1;
+}
+
+void
+CompressedTransitTag::Serialize (TagBuffer i) const
+{
+  i.WriteU8 (m_hops);
+}
+
+void
+CompressedTransitTag::Deserialize (TagBuffer i)
+{
+  m_hops = i.ReadU8 ();
+}
+
+void
+CompressedTransitTag::Print (std::ostream &os) const
+{
+  os << "hops=" << (uint32_t) m_hops;
+}
+
+void
+CompressedTransitTag::SetHops (uint8_t hops)
+{
+  m_hops = hops;
+}
+
+uint8_t
+CompressedTransitTag::GetHops (void) const
+{
+  return m_hops;
+}
+
+} // namespace ns3
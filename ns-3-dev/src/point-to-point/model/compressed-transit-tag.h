@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSED_TRANSIT_TAG_H
+#define COMPRESSED_TRANSIT_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Packet tag marking an IPv4 datagram whose payload is still deflated.
+ *
+ * A PointToPointNetDevice with compressed transit enabled receives PPP
+ * 0x4021 frames without expanding them: it hands the datagram up as IPv4,
+ * so the node routes it on its unchanged IPv4 header, and attaches this
+ * tag.  The device the datagram leaves the node through removes the tag
+ * and sends the frame as 0x4021 again, without running its own codec.
+ * The payload is only inflated by the device that has decompression
+ * enabled, at the egress of the compression domain.
+ */
+class CompressedTransitTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  CompressedTransitTag ();
+
+  /**
+   * \param hops the number of routers the datagram crossed compressed
+   */
+  void SetHops (uint8_t hops);
+
+  /**
+   * \return the number of routers the datagram crossed compressed
+   */
+  uint8_t GetHops (void) const;
+
+private:
+  uint8_t m_hops; //!< Routers crossed without decompression
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSED_TRANSIT_TAG_H */
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "compression-controller.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionController");
+
+namespace {
+
+// Weight of a new observation in the running ratio
+const double RATIO_GAIN = 0.125;
+
+// Relative cost reduction needed to change level
+const double HYSTERESIS = 0.005;
+
+} // anonymous namespace
+
+CompressionController::CompressionController ()
+  : m_configured (MAX_LEVEL),
+    m_level (MAX_LEVEL),
+    m_adaptive (false),
+    m_fastBps (800e6),
+    m_bestBps (80e6),
+    m_interval (MilliSeconds (10)),
+    m_probeInterval (64),
+    m_levelGain (0.02)
+{
+  Reset ();
+}
+
+void
+CompressionController::SetLevel (int level)
+{
+  NS_LOG_FUNCTION (this << level);
+  NS_ABORT_MSG_IF (level < 0 || level > MAX_LEVEL, "CompressionController: level " << level << " out of 0-9");
+  m_configured = level;
+  m_level = level;
+}
+
+int
+CompressionController::GetLevel (void) const
+{
+  return m_level;
+}
+
+void
+CompressionController::SetAdaptive (bool adaptive)
+{
+  NS_LOG_FUNCTION (this << adaptive);
+  m_adaptive = adaptive;
+}
+
+bool
+CompressionController::IsAdaptive (void) const
+{
+  return m_adaptive;
+}
+
+void
+CompressionController::SetCodecRates (double fastBps, double bestBps)
+{
+  NS_LOG_FUNCTION (this << fastBps << bestBps);
+  NS_ABORT_MSG_IF (fastBps <= 0 || bestBps <= 0, "CompressionController: codec rates must be positive");
+  m_fastBps = fastBps;
+  m_bestBps = bestBps;
+}
+
+double
+CompressionController::GetFastCodecRate (void) const
+{
+  return m_fastBps;
+}
+
+double
+CompressionController::GetBestCodecRate (void) const
+{
+  return m_bestBps;
+}
+
+void
+CompressionController::SetInterval (Time interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  m_interval = interval;
+}
+
+Time
+CompressionController::GetInterval (void) const
+{
+  return m_interval;
+}
+
+void
+CompressionController::SetProbeInterval (uint32_t packets)
+{
+  NS_LOG_FUNCTION (this << packets);
+  m_probeInterval = packets;
+}
+
+uint32_t
+CompressionController::GetProbeInterval (void) const
+{
+  return m_probeInterval;
+}
+
+void
+CompressionController::SetLevelGain (double gain)
+{
+  NS_LOG_FUNCTION (this << gain);
+  NS_ABORT_MSG_IF (gain < 0 || gain >= 1, "CompressionController: level gain must be in [0, 1)");
+  m_levelGain = gain;
+}
+
+double
+CompressionController::GetLevelGain (void) const
+{
+  return m_levelGain;
+}
+
+void
+CompressionController::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_level = m_configured;
+  for (int level = 0; level <= MAX_LEVEL; level++)
+    {
+      m_ratio[level] = 1;
+      m_observed[level] = false;
+    }
+  m_anyObserved = false;
+  m_intervalStart = Time (0);
+  m_intervalBytes = 0;
+  m_offeredBps = 0;
+  m_decided = false;
+  m_sinceProbe = 0;
+}
+
+double
+CompressionController::GetPrior (int level) const
+{
+  return 1 + m_levelGain * (MAX_LEVEL - level);
+}
+
+double
+CompressionController::GetRatio (int level) const
+{
+  if (level == 0)
+    {
+      return 1;
+    }
+  if (m_observed[level])
+    {
+      return m_ratio[level];
+    }
+  // borrow from the nearest observed level, the higher one on a tie
+  for (int distance = 1; distance < MAX_LEVEL; distance++)
+    {
+      for (int k = level + distance; k >= level - distance; k -= 2 * distance)
+        {
+          if (k >= 1 && k <= MAX_LEVEL && m_observed[k])
+            {
+              return m_ratio[k] * GetPrior (level) / GetPrior (k);
+            }
+        }
+    }
+  return GetPrior (level);
+}
+
+double
+CompressionController::GetCodecTime (int level, uint32_t bytes) const
+{
+  if (level == 0)
+    {
+      return 0;
+    }
+  double rate = m_fastBps * std::pow (m_bestBps / m_fastBps, (level - 1) / double (MAX_LEVEL - 1));
+  return bytes * 8.0 / rate;
+}
+
+double
+CompressionController::GetCost (int level, uint32_t bytes, double linkBps, bool backlogged) const
+{
+  double codec = GetCodecTime (level, bytes);
+  double wire = bytes * GetRatio (level) * 8.0 / linkBps;
+  return backlogged ? std::max (codec, wire) : codec + wire;
+}
+
+int
+CompressionController::Decide (Time now, uint32_t frameBytes, uint32_t queueBytes, double linkBps)
+{
+  if (!m_adaptive)
+    {
+      return m_level;
+    }
+
+  if (m_interval.IsZero ())
+    {
+      m_decided = false;
+    }
+  else if (now - m_intervalStart >= m_interval)
+    {
+      m_offeredBps = m_intervalBytes * 8.0 / (now - m_intervalStart).GetSeconds ();
+      m_intervalStart = now;
+      m_intervalBytes = 0;
+      m_decided = false;
+    }
+  m_intervalBytes += frameBytes;
+
+  // keep the configured level until there is a ratio to reason about
+  if (!m_decided && m_anyObserved && linkBps > 0)
+    {
+      bool backlogged = queueBytes > 0 || m_offeredBps >= linkBps;
+      double current = GetCost (m_level, frameBytes, linkBps, backlogged);
+      int best = m_level;
+      double bestCost = current;
+      for (int level = 0; level <= MAX_LEVEL; level++)
+        {
+          double cost = GetCost (level, frameBytes, linkBps, backlogged);
+          if (cost < bestCost)
+            {
+              best = level;
+              bestCost = cost;
+            }
+        }
+      if (best != m_level && bestCost < current * (1 - HYSTERESIS))
+        {
+          NS_LOG_LOGIC ("level " << m_level << " -> " << best << ", queue " << queueBytes
+                        << " bytes, offered " << m_offeredBps << " bps");
+          m_level = best;
+          m_sinceProbe = 0;
+        }
+      m_decided = !m_interval.IsZero ();
+    }
+
+  if (m_level == 0 && m_probeInterval > 0 && ++m_sinceProbe >= m_probeInterval)
+    {
+      m_sinceProbe = 0;
+      return 1;
+    }
+  return m_level;
+}
+
+void
+CompressionController::NotifyCompressed (int level, uint32_t bytesIn, uint32_t bytesOut)
+{
+  if (level < 1 || level > MAX_LEVEL || bytesIn == 0)
+    {
+      return;
+    }
+  double ratio = bytesOut / double (bytesIn);
+  m_ratio[level] = m_observed[level] ? m_ratio[level] + RATIO_GAIN * (ratio - m_ratio[level]) : ratio;
+  m_observed[level] = true;
+  m_anyObserved = true;
+}
+
+} // namespace ns3
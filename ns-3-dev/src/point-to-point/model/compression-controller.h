@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSION_CONTROLLER_H
+#define COMPRESSION_CONTROLLER_H
+
+#include <stdint.h>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Picks the deflate level of a compressing link, or turns it off.
+ *
+ * Level 0 means frames are sent uncompressed; 1 to 9 are zlib levels.
+ * With a fixed level the controller only returns it.  In adaptive mode
+ * it estimates, for every level, the time a frame spends in the codec
+ * and on the wire and keeps the level with the smallest cost:
+ *
+ *   - codec time is the frame size over a modeled codec throughput,
+ *     interpolated geometrically between the level 1 and level 9 rates;
+ *   - wire time is the frame size times the compression ratio over the
+ *     link data rate.  Each level keeps a running average of the frames
+ *     it compressed.  A level with no frames yet borrows the average of
+ *     the nearest level that has some, assuming LevelGain smaller output
+ *     per level above it; the gain is an assumption, not a measurement,
+ *     and stops mattering once the level has been used;
+ *   - when the link is backlogged (frames queued, or the offered load of
+ *     the last interval at or above the data rate) the codec and the
+ *     wire are assumed to work in parallel and the cost is the larger of
+ *     the two; an idle link pays both in turn.
+ *
+ * This is a heuristic for the wall-clock cost of a real link, whose CPU
+ * deflates the frames.  The simulator never charges the codec time: a
+ * compressed frame is on the wire as soon as it is sent, so in simulated
+ * time a lower level can only cost wire time and a fixed level 9 is never
+ * slower.  Simulations show which level the controller picks and when, not
+ * the goodput it would win on real hardware.
+ *
+ * Incompressible traffic makes every level cost more wire time than
+ * level 0, so compression turns off; one frame in ProbeInterval is then
+ * still compressed at level 1 so the controller notices when the traffic
+ * becomes compressible again.  A new level is only adopted when it is
+ * cheaper than the current one by more than half a percent, and at most
+ * once per control interval.
+ */
+class CompressionController
+{
+public:
+  /// Highest deflate level
+  static const int MAX_LEVEL = 9;
+
+  CompressionController ();
+
+  /**
+   * \brief Use a fixed level, or start the adaptive search from it
+   * \param level 0 for no compression, 1 to 9 for deflate
+   */
+  void SetLevel (int level);
+
+  /**
+   * \return the level currently chosen, 0 for no compression
+   */
+  int GetLevel (void) const;
+
+  /**
+   * \param adaptive whether to choose the level from the link state
+   */
+  void SetAdaptive (bool adaptive);
+
+  /**
+   * \return whether the level is chosen from the link state
+   */
+  bool IsAdaptive (void) const;
+
+  /**
+   * \brief Set the modeled codec throughput
+   * \param fastBps bits per second deflated at level 1
+   * \param bestBps bits per second deflated at level 9
+   */
+  void SetCodecRates (double fastBps, double bestBps);
+
+  /**
+   * \return the modeled codec throughput at level 1, in bits per second
+   */
+  double GetFastCodecRate (void) const;
+
+  /**
+   * \return the modeled codec throughput at level 9, in bits per second
+   */
+  double GetBestCodecRate (void) const;
+
+  /**
+   * \brief Set how often the level may change
+   * \param interval the control interval, zero to decide on every frame
+   */
+  void SetInterval (Time interval);
+
+  /**
+   * \return the control interval
+   */
+  Time GetInterval (void) const;
+
+  /**
+   * \param packets frames between probes while compression is off, 0 never probes
+   */
+  void SetProbeInterval (uint32_t packets);
+
+  /**
+   * \return frames between probes while compression is off
+   */
+  uint32_t GetProbeInterval (void) const;
+
+  /**
+   * \param gain assumed output size reduction per level, relative to the
+   *        level below, used for levels that have compressed no frame yet
+   */
+  void SetLevelGain (double gain);
+
+  /**
+   * \return the assumed output size reduction per level
+   */
+  double GetLevelGain (void) const;
+
+  /**
+   * \brief Forget the observed ratios and go back to the configured level
+   */
+  void Reset (void);
+
+  /**
+   * \brief Choose the level of the next frame
+   *
+   * The returned level differs from GetLevel only for a probe.
+   *
+   * \param now the current time
+   * \param frameBytes size of the uncompressed frame
+   * \param queueBytes bytes waiting in the transmit queue
+   * \param linkBps the link data rate in bits per second
+   * \return the level to compress the frame with, 0 to send it as is
+   */
+  int Decide (Time now, uint32_t frameBytes, uint32_t queueBytes, double linkBps);
+
+  /**
+   * \brief Report the outcome of compressing a frame
+   *
+   * Sizes are of the compressed payload alone, without the headers that
+   * travel around it, whichever path compressed the frame.
+   *
+   * \param level the level used
+   * \param bytesIn payload size before compression
+   * \param bytesOut payload size after compression
+   */
+  void NotifyCompressed (int level, uint32_t bytesIn, uint32_t bytesOut);
+
+  /**
+   * \param level a level from 0 to 9
+   * \return the estimated compressed over uncompressed frame size, the
+   *         level's own average once it has compressed a frame
+   */
+  double GetRatio (int level) const;
+
+  /**
+   * \param level a level from 0 to 9
+   * \param bytes bytes deflated
+   * \return the modeled codec time in seconds
+   */
+  double GetCodecTime (int level, uint32_t bytes) const;
+
+private:
+  /**
+   * \param level a level from 0 to 9
+   * \param bytes size of the uncompressed frame
+   * \param linkBps the link data rate
+   * \param backlogged whether codec and wire overlap
+   * \return the modeled cost of sending the frame at level, in seconds
+   */
+  double GetCost (int level, uint32_t bytes, double linkBps, bool backlogged) const;
+
+  /**
+   * \param level a level from 1 to 9
+   * \return the output size assumed for level, relative to level 9
+   */
+  double GetPrior (int level) const;
+
+  int m_configured;        //!< Level set by SetLevel
+  int m_level;             //!< Level currently chosen
+  bool m_adaptive;         //!< Choose the level from the link state
+  double m_fastBps;        //!< Modeled codec throughput at level 1
+  double m_bestBps;        //!< Modeled codec throughput at level 9
+  Time m_interval;         //!< Control interval
+  uint32_t m_probeInterval; //!< Frames between probes while off
+  double m_levelGain;      //!< Assumed output reduction per level
+  double m_ratio[MAX_LEVEL + 1];   //!< Running compression ratio of each level
+  bool m_observed[MAX_LEVEL + 1];  //!< m_ratio of the level holds an observation
+  bool m_anyObserved;      //!< Some level holds an observation
+  Time m_intervalStart;    //!< Start of the current control interval
+  uint64_t m_intervalBytes; //!< Bytes offered in the current interval
+  double m_offeredBps;     //!< Offered load of the last complete interval
+  bool m_decided;          //!< A level was adopted in the current interval
+  uint32_t m_sinceProbe;   //!< Frames sent uncompressed since the last probe
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSION_CONTROLLER_H */
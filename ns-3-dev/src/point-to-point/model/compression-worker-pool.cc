@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "compression-worker-pool.h"
+#include "zlib-codec.h"
+#include <chrono>
+#include <utility>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CompressionWorkerPool");
+
+CompressionJob::CompressionJob (std::string input, int level)
+  : m_input (std::move (input)),
+    m_level (level),
+    m_state (PENDING)
+{
+}
+
+bool
+CompressionJob::TryRun (void)
+{
+  int expected = PENDING;
+  if (!m_state.compare_exchange_strong (expected, RUNNING))
+    {
+      return false;
+    }
+  // One set of zlib streams per thread, reused across jobs.
+  static thread_local ZlibCodec codec;
+  static const std::string noPrefix;
+  try
+    {
+      codec.SetLevel (m_level);
+      codec.Compress (noPrefix, reinterpret_cast<const uint8_t *> (m_input.data ()), m_input.size (), m_output);
+    }
+  catch (...)
+    {
+      m_error = std::current_exception ();
+    }
+  m_input.clear ();
+  m_state.store (DONE, std::memory_order_release);
+  return true;
+}
+
+const std::string &
+CompressionJob::Wait (void)
+{
+  if (!TryRun ())
+    {
+      while (m_state.load (std::memory_order_acquire) != DONE)
+        {
+          std::this_thread::yield ();
+        }
+    }
+  if (m_error)
+    {
+      std::rethrow_exception (m_error);
+    }
+  return m_output;
+}
+
+CompressionWorkerPool::CompressionWorkerPool (uint32_t nThreads)
+  : m_ring (RING_SIZE),
+    m_enqueuePos (0),
+    m_dequeuePos (0),
+    m_stop (false),
+    m_sleepers (0)
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  for (uint64_t i = 0; i < RING_SIZE; i++)
+    {
+      m_ring[i].sequence.store (i, std::memory_order_relaxed);
+    }
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      m_threads.push_back (std::thread (&CompressionWorkerPool::WorkerLoop, this));
+    }
+}
+
+CompressionWorkerPool::~CompressionWorkerPool ()
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop.store (true);
+  }
+  m_wakeup.notify_all ();
+  for (std::size_t i = 0; i < m_threads.size (); i++)
+    {
+      m_threads[i].join ();
+    }
+}
+
+uint32_t
+CompressionWorkerPool::GetNThreads (void) const
+{
+  return m_threads.size ();
+}
+
+std::shared_ptr<CompressionJob>
+CompressionWorkerPool::Submit (std::string input, int level)
+{
+  std::shared_ptr<CompressionJob> job = std::make_shared<CompressionJob> (std::move (input), level);
+  if (!Push (job))
+    {
+      NS_LOG_LOGIC ("Ring full, job left for the waiting thread");
+      return job;
+    }
+  if (m_sleepers.load () > 0)
+    {
+      m_wakeup.notify_one ();
+    }
+  return job;
+}
+
+bool
+CompressionWorkerPool::Push (const std::shared_ptr<CompressionJob> &job)
+{
+  uint64_t pos = m_enqueuePos.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      Cell &cell = m_ring[pos & (RING_SIZE - 1)];
+      uint64_t seq = cell.sequence.load (std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t> (seq) - static_cast<int64_t> (pos);
+      if (diff == 0)
+        {
+          if (m_enqueuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              cell.job = job;
+              cell.sequence.store (pos + 1, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (diff < 0)
+        {
+          return false;
+        }
+      else
+        {
+          pos = m_enqueuePos.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+bool
+CompressionWorkerPool::Pop (std::shared_ptr<CompressionJob> &job)
+{
+  uint64_t pos = m_dequeuePos.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      Cell &cell = m_ring[pos & (RING_SIZE - 1)];
+      uint64_t seq = cell.sequence.load (std::memory_order_acquire);
+      int64_t diff = static_cast<int64_t> (seq) - static_cast<int64_t> (pos + 1);
+      if (diff == 0)
+        {
+          if (m_dequeuePos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              job.swap (cell.job);
+              cell.sequence.store (pos + RING_SIZE, std::memory_order_release);
+              return true;
+            }
+        }
+      else if (diff < 0)
+        {
+          return false;
+        }
+      else
+        {
+          pos = m_dequeuePos.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+CompressionWorkerPool::WorkerLoop (void)
+{
+  uint32_t idle = 0;
+  while (!m_stop.load ())
+    {
+      std::shared_ptr<CompressionJob> job;
+      if (Pop (job))
+        {
+          job->TryRun ();
+          idle = 0;
+          continue;
+        }
+      if (++idle < 64)
+        {
+          std::this_thread::yield ();
+          continue;
+        }
+      // Nothing to do for a while: sleep until a Submit wakes us.  The
+      // timeout covers a notification racing with m_sleepers.
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_sleepers++;
+      m_wakeup.wait_for (lock, std::chrono::milliseconds (1));
+      m_sleepers--;
+      idle = 0;
+    }
+}
+
+} // namespace ns3
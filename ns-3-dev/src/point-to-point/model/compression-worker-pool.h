@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COMPRESSION_WORKER_POOL_H
+#define COMPRESSION_WORKER_POOL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief One payload handed to a CompressionWorkerPool.
+ *
+ * Jobs only carry plain byte strings: Packet and Ptr are not thread safe,
+ * so the simulator thread extracts the payload before submitting it and
+ * rebuilds the packet once the job is done.
+ */
+class CompressionJob
+{
+public:
+  /**
+   * \param input the bytes to compress
+   * \param level the zlib compression level
+   */
+  CompressionJob (std::string input, int level);
+
+  /**
+   * \brief Compress the input unless another thread already claimed the job
+   * \return true if this call ran the job
+   */
+  bool TryRun (void);
+
+  /**
+   * \brief Wait for the job, running it on the calling thread if no worker
+   * has picked it up yet
+   * \return the compressed bytes
+   */
+  const std::string & Wait (void);
+
+private:
+  /// Job life cycle
+  enum State
+  {
+    PENDING,
+    RUNNING,
+    DONE
+  };
+
+  std::string m_input;  //!< Uncompressed bytes
+  std::string m_output; //!< Compressed bytes, valid once DONE
+  int m_level;          //!< zlib compression level
+  std::atomic<int> m_state; //!< Current State
+  std::exception_ptr m_error; //!< Error raised by the codec, rethrown by Wait
+};
+
+/**
+ * \ingroup point-to-point
+ * \brief Fixed set of threads compressing payloads ahead of transmission.
+ *
+ * Jobs are passed to the workers through a bounded lock-free MPMC ring
+ * (D. Vyukov's sequence-numbered array queue).  The pool only changes how
+ * much wall-clock time compression takes: the caller always consumes the
+ * results in submission order, and deflate is a pure function of its input,
+ * so simulations stay deterministic whatever the number of threads.
+ */
+class CompressionWorkerPool
+{
+public:
+  /**
+   * \param nThreads number of worker threads to start
+   */
+  CompressionWorkerPool (uint32_t nThreads);
+  ~CompressionWorkerPool ();
+
+  /**
+   * \brief Queue a payload for compression
+   * \param input the bytes to compress
+   * \param level the zlib compression level
+   * \return the job; if the ring is full it is returned unclaimed and
+   * runs on the first thread that waits for it
+   */
+  std::shared_ptr<CompressionJob> Submit (std::string input, int level);
+
+  /**
+   * \return the number of worker threads
+   */
+  uint32_t GetNThreads (void) const;
+
+private:
+  /// One slot of the ring
+  struct Cell
+  {
+    std::atomic<uint64_t> sequence;      //!< Slot turn counter
+    std::shared_ptr<CompressionJob> job; //!< Job stored in the slot
+  };
+
+  bool Push (const std::shared_ptr<CompressionJob> &job);
+  bool Pop (std::shared_ptr<CompressionJob> &job);
+  void WorkerLoop (void);
+
+  static const uint64_t RING_SIZE = 8192; //!< Ring capacity, a power of two
+
+  std::vector<Cell> m_ring;             //!< Job ring
+  std::atomic<uint64_t> m_enqueuePos;   //!< Next slot to fill
+  std::atomic<uint64_t> m_dequeuePos;   //!< Next slot to drain
+  std::vector<std::thread> m_threads;   //!< Worker threads
+  std::atomic<bool> m_stop;             //!< Set when the pool shuts down
+  std::atomic<uint32_t> m_sleepers;     //!< Workers blocked on m_wakeup
+  std::mutex m_mutex;                   //!< Protects m_wakeup
+  std::condition_variable m_wakeup;     //!< Signalled on new jobs
+};
+
+} // namespace ns3
+
+#endif /* COMPRESSION_WORKER_POOL_H */
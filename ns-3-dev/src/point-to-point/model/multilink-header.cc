@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "multilink-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultilinkHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (MultilinkHeader);
+
+MultilinkHeader::MultilinkHeader ()
+  : m_begin (true),
+    m_end (true),
+    m_sequence (0)
+{
+}
+
+TypeId
+MultilinkHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultilinkHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<MultilinkHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MultilinkHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+MultilinkHeader::Print (std::ostream &os) const
+{
+  os << "Multilink PPP: seq=" << m_sequence
+     << (m_begin ? " B" : "") << (m_end ? " E" : "");
+}
+
+uint32_t
+MultilinkHeader::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+MultilinkHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteU8 ((m_begin ? 0x80 : 0) | (m_end ? 0x40 : 0));
+  start.WriteU8 (m_sequence >> 16);
+  start.WriteHtonU16 (m_sequence & 0xffff);
+}
+
+uint32_t
+MultilinkHeader::Deserialize (Buffer::Iterator start)
+{
+  uint8_t flags = start.ReadU8 ();
+  m_begin = (flags & 0x80) != 0;
+  m_end = (flags & 0x40) != 0;
+  m_sequence = start.ReadU8 () << 16;
+  m_sequence |= start.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+void
+MultilinkHeader::SetBegin (bool begin)
+{
+  m_begin = begin;
+}
+
+bool
+MultilinkHeader::IsBegin (void) const
+{
+  return m_begin;
+}
+
+void
+MultilinkHeader::SetEnd (bool end)
+{
+  m_end = end;
+}
+
+bool
+MultilinkHeader::IsEnd (void) const
+{
+  return m_end;
+}
+
+void
+MultilinkHeader::SetSequence (uint32_t sequence)
+{
+  m_sequence = sequence & (SEQUENCE_SPAN - 1);
+}
+
+uint32_t
+MultilinkHeader::GetSequence (void) const
+{
+  return m_sequence;
+}
+
+} // namespace ns3
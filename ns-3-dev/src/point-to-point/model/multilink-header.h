@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTILINK_HEADER_H
+#define MULTILINK_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Multilink PPP fragment header, long sequence number format
+ *
+ * Follows the PPP protocol field 0x003d of every fragment a
+ * MultilinkPppNetDevice sends over its member links (RFC 1990, 3.):
+ *
+ * \verbatim
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |B|E|0|0|0|0|0|0|           sequence number (24 bits)           |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
+ *
+ * B marks the first fragment of a frame and E the last one; an
+ * unfragmented frame has both.  Sequence numbers count fragments, not
+ * frames, and wrap around after 2^24.
+ */
+class MultilinkHeader : public Header
+{
+public:
+  /// Number of distinct sequence numbers
+  static const uint32_t SEQUENCE_SPAN = 1 << 24;
+
+  MultilinkHeader ();
+
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual uint32_t GetSerializedSize (void) const;
+
+  /**
+   * \param begin whether the fragment starts a frame
+   */
+  void SetBegin (bool begin);
+
+  /**
+   * \return whether the fragment starts a frame
+   */
+  bool IsBegin (void) const;
+
+  /**
+   * \param end whether the fragment ends a frame
+   */
+  void SetEnd (bool end);
+
+  /**
+   * \return whether the fragment ends a frame
+   */
+  bool IsEnd (void) const;
+
+  /**
+   * \param sequence the fragment sequence number, only the low 24 bits are kept
+   */
+  void SetSequence (uint32_t sequence);
+
+  /**
+   * \return the 24 bit fragment sequence number
+   */
+  uint32_t GetSequence (void) const;
+
+private:
+  bool m_begin;        //!< B bit
+  bool m_end;          //!< E bit
+  uint32_t m_sequence; //!< 24 bit sequence number
+};
+
+} // namespace ns3
+
+#endif /* MULTILINK_HEADER_H */
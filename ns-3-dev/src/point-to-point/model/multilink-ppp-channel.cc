@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "multilink-ppp-channel.h"
+#include "multilink-ppp-net-device.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultilinkPppChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (MultilinkPppChannel);
+
+TypeId
+MultilinkPppChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultilinkPppChannel")
+    .SetParent<Channel> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<MultilinkPppChannel> ()
+  ;
+  return tid;
+}
+
+MultilinkPppChannel::MultilinkPppChannel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultilinkPppChannel::Attach (Ptr<MultilinkPppNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  NS_ABORT_MSG_IF (m_devices.size () >= 2, "MultilinkPppChannel: a bundle has two ends");
+  m_devices.push_back (device);
+}
+
+std::size_t
+MultilinkPppChannel::GetNDevices (void) const
+{
+  return m_devices.size ();
+}
+
+Ptr<NetDevice>
+MultilinkPppChannel::GetDevice (std::size_t i) const
+{
+  NS_ASSERT (i < m_devices.size ());
+  return m_devices[i];
+}
+
+void
+MultilinkPppChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_devices.clear ();
+  Channel::DoDispose ();
+}
+
+} // namespace ns3
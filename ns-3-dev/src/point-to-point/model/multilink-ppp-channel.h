@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTILINK_PPP_CHANNEL_H
+#define MULTILINK_PPP_CHANNEL_H
+
+#include <vector>
+#include "ns3/channel.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class MultilinkPppNetDevice;
+
+/**
+ * \ingroup point-to-point
+ * \brief The logical link between the two ends of a Multilink PPP bundle
+ *
+ * Carries no frames itself: the member PointToPointChannels do.  It
+ * exists so that the bundle looks like one point-to-point link to the
+ * layers above, e.g. global routing finds the peer bundle through it.
+ */
+class MultilinkPppChannel : public Channel
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  MultilinkPppChannel ();
+
+  /**
+   * \brief Attach one end of the bundle
+   *
+   * Called by MultilinkPppNetDevice::Attach.
+   *
+   * \param device the bundle end, at most two per channel
+   */
+  void Attach (Ptr<MultilinkPppNetDevice> device);
+
+  virtual std::size_t GetNDevices (void) const;
+  virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  std::vector<Ptr<MultilinkPppNetDevice> > m_devices; //!< Bundle ends
+};
+
+} // namespace ns3
+
+#endif /* MULTILINK_PPP_CHANNEL_H */
@@ -0,0 +1,770 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "multilink-ppp-net-device.h"
+#include "multilink-ppp-channel.h"
+#include "multilink-header.h"
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultilinkPppNetDevice");
+
+NS_OBJECT_ENSURE_REGISTERED (MultilinkPppNetDevice);
+
+namespace {
+
+// Ethertype the members map to PPP protocol 0x003d, multilink fragment
+const uint16_t MULTILINK_PROTOCOL = 0x0803;
+
+// PPP protocol numbers inside a multilink frame
+const uint16_t PPP_IPV4 = 0x0021;
+const uint16_t PPP_IPV6 = 0x0057;
+const uint16_t PPP_COMPRESSED = 0x00fd;
+
+} // anonymous namespace
+
+TypeId
+MultilinkPppNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultilinkPppNetDevice")
+    .SetParent<NetDevice> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<MultilinkPppNetDevice> ()
+    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit of the bundle",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&MultilinkPppNetDevice::SetMtu,
+                                         &MultilinkPppNetDevice::GetMtu),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("Address",
+                   "The MAC address of this device.",
+                   Mac48AddressValue (Mac48Address ("ff:ff:ff:ff:ff:ff")),
+                   MakeMac48AddressAccessor (&MultilinkPppNetDevice::m_address),
+                   MakeMac48AddressChecker ())
+    .AddAttribute ("MinFragmentSize",
+                   "Frames are split into one fragment per member, but none "
+                   "shorter than this many bytes",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&MultilinkPppNetDevice::m_minFragmentSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxReassemblyFragments",
+                   "Fragments buffered out of order before the oldest missing "
+                   "one is declared lost",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&MultilinkPppNetDevice::m_maxFragments),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ReassemblyTimeout",
+                   "Time a gap may hold up the fragments behind it before it "
+                   "is declared lost",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&MultilinkPppNetDevice::m_reassemblyTimeout),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("CompressionLevel",
+                   "Deflate level of the frames sent with compression enabled, "
+                   "1 to 9, or 0 to send them uncompressed",
+                   UintegerValue (Z_BEST_COMPRESSION),
+                   MakeUintegerAccessor (&MultilinkPppNetDevice::m_level),
+                   MakeUintegerChecker<uint32_t> (0, 9))
+    .AddTraceSource ("MacTx",
+                     "Trace source indicating a datagram has arrived "
+                     "for transmission by this bundle",
+                     MakeTraceSourceAccessor (&MultilinkPppNetDevice::m_macTxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("MacTxDrop",
+                     "Trace source indicating a datagram, or one of its "
+                     "fragments, has been dropped by the bundle before "
+                     "transmission",
+                     MakeTraceSourceAccessor (&MultilinkPppNetDevice::m_macTxDropTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("MacRx",
+                     "A reassembled datagram has been received by this bundle "
+                     "and is being forwarded up the stack",
+                     MakeTraceSourceAccessor (&MultilinkPppNetDevice::m_macRxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("PromiscSniffer",
+                     "Trace source simulating a promiscuous packet sniffer "
+                     "attached to every member: the PPP frames of the "
+                     "fragments, sent and received",
+                     MakeTraceSourceAccessor (&MultilinkPppNetDevice::m_promiscSnifferTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+MultilinkPppNetDevice::MultilinkPppNetDevice ()
+  : m_ifIndex (0),
+    m_mtu (1500),
+    m_linkUp (false),
+    m_nextMember (0),
+    m_minFragmentSize (256),
+    m_maxFragments (1024),
+    m_reassemblyTimeout (MilliSeconds (100)),
+    m_txSequence (0),
+    m_expected (0),
+    m_gap (0),
+    m_level (Z_BEST_COMPRESSION)
+{
+  NS_LOG_FUNCTION (this);
+  ResetCodec ();
+}
+
+MultilinkPppNetDevice::~MultilinkPppNetDevice ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultilinkPppNetDevice::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_members.size (); i++)
+    {
+      m_members[i]->Dispose ();
+    }
+  m_members.clear ();
+  m_reassemblyEvent.Cancel ();
+  m_reassembly.clear ();
+  m_frame.clear ();
+  m_node = 0;
+  m_channel = 0;
+  NetDevice::DoDispose ();
+}
+
+void
+MultilinkPppNetDevice::AddMember (Ptr<PointToPointNetDevice> member)
+{
+  NS_LOG_FUNCTION (this << member);
+  if (m_node)
+    {
+      member->SetNode (m_node);
+    }
+  member->SetReceiveCallback (MakeCallback (&MultilinkPppNetDevice::ReceiveFromMember, this));
+  member->TraceConnectWithoutContext ("PromiscSniffer", MakeCallback (&MultilinkPppNetDevice::NotifySniffer, this));
+  m_members.push_back (member);
+  m_memberNext.push_back (0);
+}
+
+uint32_t
+MultilinkPppNetDevice::GetNMembers (void) const
+{
+  return m_members.size ();
+}
+
+Ptr<PointToPointNetDevice>
+MultilinkPppNetDevice::GetMember (uint32_t i) const
+{
+  NS_ASSERT (i < m_members.size ());
+  return m_members[i];
+}
+
+void
+MultilinkPppNetDevice::Attach (Ptr<MultilinkPppChannel> ch)
+{
+  NS_LOG_FUNCTION (this << ch);
+  m_channel = ch;
+  ch->Attach (this);
+  if (ch->GetNDevices () == 2)
+    {
+      for (std::size_t i = 0; i < 2; i++)
+        {
+          Ptr<MultilinkPppNetDevice> end = DynamicCast<MultilinkPppNetDevice> (ch->GetDevice (i));
+          end->m_linkUp = true;
+          end->m_linkChangeCallbacks ();
+        }
+    }
+}
+
+void
+MultilinkPppNetDevice::EnableCompression (void)
+{
+  m_compress = true;
+}
+
+void
+MultilinkPppNetDevice::EnableDecompression (void)
+{
+  m_decompress = true;
+}
+
+bool
+MultilinkPppNetDevice::GetCompression (void) const
+{
+  return m_compress;
+}
+
+bool
+MultilinkPppNetDevice::GetDecompression (void) const
+{
+  return m_decompress;
+}
+
+int
+MultilinkPppNetDevice::GetCompressionLevel (void) const
+{
+  return m_compress ? m_level : 0;
+}
+
+PointToPointNetDevice::CodecStats
+MultilinkPppNetDevice::GetCodecStats (PointToPointNetDevice::CodecDirection direction) const
+{
+  NS_ASSERT (direction < PointToPointNetDevice::N_DIRECTIONS);
+  return m_codecStats[direction];
+}
+
+uint64_t
+MultilinkPppNetDevice::GetCodecPackets (void) const
+{
+  return m_codecStats[PointToPointNetDevice::EGRESS].packets
+         + m_codecStats[PointToPointNetDevice::INGRESS].packets;
+}
+
+uint64_t
+MultilinkPppNetDevice::GetLostFragments (void) const
+{
+  return m_lostFragments;
+}
+
+uint64_t
+MultilinkPppNetDevice::GetReassembledFrames (void) const
+{
+  return m_reassembledFrames;
+}
+
+void
+MultilinkPppNetDevice::ResetCodec (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_compress = false;
+  m_decompress = false;
+  for (int d = 0; d < PointToPointNetDevice::N_DIRECTIONS; d++)
+    {
+      m_codecStats[d].packets = 0;
+      m_codecStats[d].bytesIn = 0;
+      m_codecStats[d].bytesOut = 0;
+    }
+  m_lostFragments = 0;
+  m_reassembledFrames = 0;
+  for (uint32_t i = 0; i < m_members.size (); i++)
+    {
+      m_members[i]->ResetCodec ();
+    }
+}
+
+bool
+MultilinkPppNetDevice::Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << dest << protocolNumber);
+  bool memberUp = false;
+  for (uint32_t i = 0; i < m_members.size () && !memberUp; i++)
+    {
+      memberUp = m_members[i]->IsLinkUp ();
+    }
+  if (!m_linkUp || !memberUp)
+    {
+      // no sequence number is taken, the peer has no gap to wait for
+      m_macTxDropTrace (packet);
+      return false;
+    }
+
+  uint16_t protocol;
+  switch (protocolNumber)
+    {
+    case 0x0800: protocol = PPP_IPV4; break;
+    case 0x86DD: protocol = PPP_IPV6; break;
+    default:
+      NS_LOG_WARN ("dropping a datagram of unsupported protocol " << protocolNumber);
+      m_macTxDropTrace (packet);
+      return false;
+    }
+  m_macTxTrace (packet);
+
+  //
+  // The frame is the PPP protocol number followed by the datagram, or
+  // 0x00fd followed by the deflated frame.
+  //
+  uint32_t size = packet->GetSize ();
+  m_txFrame.resize (2 + size);
+  m_txFrame[0] = protocol >> 8;
+  m_txFrame[1] = protocol & 0xff;
+  packet->CopyData (reinterpret_cast<uint8_t *> (&m_txFrame[2]), size);
+  if (m_compress && m_level > 0)
+    {
+      m_zlib.SetLevel (m_level);
+      m_zlib.Compress (std::string (), reinterpret_cast<const uint8_t *> (m_txFrame.data ()), m_txFrame.size (), m_codecScratch);
+      PointToPointNetDevice::CodecStats &stats = m_codecStats[PointToPointNetDevice::EGRESS];
+      stats.bytesIn += size;
+      stats.bytesOut += m_codecScratch.size ();
+      stats.packets++;
+      m_txFrame.resize (2);
+      m_txFrame[0] = PPP_COMPRESSED >> 8;
+      m_txFrame[1] = PPP_COMPRESSED & 0xff;
+      m_txFrame.append (m_codecScratch);
+    }
+
+  uint32_t frameSize = m_txFrame.size ();
+  uint32_t fragments = std::min<uint32_t> (m_members.size (), std::max<uint32_t> (1, frameSize / m_minFragmentSize));
+  uint32_t offset = 0;
+  bool sent = true;
+  for (uint32_t i = 0; i < fragments; i++)
+    {
+      uint32_t length = (frameSize - offset) / (fragments - i);
+
+      // a copy keeps the packet tags; its bytes are replaced by the fragment's
+      Ptr<Packet> fragment = packet->Copy ();
+      fragment->RemoveAtEnd (fragment->GetSize ());
+      fragment->AddAtEnd (Create<Packet> (reinterpret_cast<const uint8_t *> (m_txFrame.data ()) + offset, length));
+      offset += length;
+
+      MultilinkHeader header;
+      header.SetBegin (i == 0);
+      header.SetEnd (i == fragments - 1);
+      header.SetSequence (m_txSequence++);
+      fragment->AddHeader (header);
+
+      Ptr<PointToPointNetDevice> member = m_members[PickMember (fragment->GetSize ())];
+      if (!member->Send (fragment, member->GetBroadcast (), MULTILINK_PROTOCOL))
+        {
+          // the peer finds the gap and drops the rest of the frame
+          sent = false;
+        }
+    }
+  if (!sent)
+    {
+      m_macTxDropTrace (packet);
+    }
+  return sent;
+}
+
+uint32_t
+MultilinkPppNetDevice::PickMember (uint32_t bytes)
+{
+  //
+  // Start the search after the last member picked, so that members which
+  // would finish at the same time take turns.
+  //
+  uint32_t n = m_members.size ();
+  uint32_t best = n;
+  double bestTime = std::numeric_limits<double>::infinity ();
+  for (uint32_t k = 0; k < n; k++)
+    {
+      uint32_t i = (m_nextMember + k) % n;
+      Ptr<PointToPointNetDevice> member = m_members[i];
+      if (!member->IsLinkUp ())
+        {
+          continue;
+        }
+      // the frame on the wire, then the queue, then this fragment
+      double time = member->GetTransmitRemaining ().GetSeconds ()
+        + (member->GetQueue ()->GetNBytes () + bytes) * 8.0 / member->GetDataRate ().GetBitRate ();
+      if (time < bestTime)
+        {
+          best = i;
+          bestTime = time;
+        }
+    }
+  if (best < n)
+    {
+      m_nextMember = (best + 1) % n;
+    }
+  return best;
+}
+
+bool
+MultilinkPppNetDevice::ReceiveFromMember (Ptr<NetDevice> member, Ptr<const Packet> packet,
+                                          uint16_t protocol, const Address &from)
+{
+  NS_LOG_FUNCTION (this << member << packet << protocol);
+  if (protocol != MULTILINK_PROTOCOL)
+    {
+      NS_LOG_WARN ("dropping a frame of protocol " << protocol << " received on a member");
+      return true;
+    }
+
+  Ptr<Packet> fragment = packet->Copy ();
+  MultilinkHeader header;
+  fragment->RemoveHeader (header);
+  uint64_t sequence = ExtendSequence (header.GetSequence ());
+  for (uint32_t i = 0; i < m_members.size (); i++)
+    {
+      if (m_members[i] == member)
+        {
+          m_memberNext[i] = std::max (m_memberNext[i], sequence + 1);
+          break;
+        }
+    }
+
+  if (sequence < m_expected)
+    {
+      // already counted lost when reassembly went past it
+      NS_LOG_LOGIC ("late fragment " << sequence << " dropped");
+    }
+  else
+    {
+      Fragment &entry = m_reassembly[sequence];
+      entry.packet = fragment;
+      entry.begin = header.IsBegin ();
+      entry.end = header.IsEnd ();
+    }
+  Reassemble ();
+  return true;
+}
+
+uint64_t
+MultilinkPppNetDevice::ExtendSequence (uint32_t sequence) const
+{
+  const uint64_t span = MultilinkHeader::SEQUENCE_SPAN;
+  uint64_t extended = (m_expected & ~(span - 1)) | sequence;
+  if (extended + span / 2 < m_expected)
+    {
+      extended += span;
+    }
+  else if (extended > m_expected + span / 2 && extended >= span)
+    {
+      extended -= span;
+    }
+  return extended;
+}
+
+uint64_t
+MultilinkPppNetDevice::GetLossBound (void) const
+{
+  // members deliver in order: below every member's last sequence nothing is still coming
+  uint64_t bound = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < m_memberNext.size (); i++)
+    {
+      if (m_members[i]->IsLinkUp ())
+        {
+          bound = std::min (bound, m_memberNext[i]);
+        }
+    }
+  return bound;
+}
+
+void
+MultilinkPppNetDevice::Reassemble (void)
+{
+  uint64_t bound = GetLossBound ();
+  while (!m_reassembly.empty ())
+    {
+      std::map<uint64_t, Fragment>::iterator it = m_reassembly.begin ();
+      if (it->first != m_expected)
+        {
+          bool overflow = m_reassembly.size () > m_maxFragments;
+          if (m_expected >= bound && !overflow)
+            {
+              // the missing fragment may still arrive, or its member has gone idle
+              if (!m_reassemblyEvent.IsRunning () || m_gap != m_expected)
+                {
+                  m_reassemblyEvent.Cancel ();
+                  m_gap = m_expected;
+                  m_reassemblyEvent = Simulator::Schedule (m_reassemblyTimeout,
+                                                           &MultilinkPppNetDevice::ExpireGap, this);
+                }
+              return;
+            }
+          uint64_t next = overflow ? it->first : std::min (it->first, bound);
+          NS_LOG_LOGIC ("fragments " << m_expected << " to " << next - 1 << " lost");
+          m_lostFragments += next - m_expected;
+          m_expected = next;
+          DiscardFrame ();
+          continue;
+        }
+
+      Fragment fragment = it->second;
+      m_reassembly.erase (it);
+      m_expected++;
+      if (fragment.begin)
+        {
+          DiscardFrame ();   // the previous frame never got its last fragment
+        }
+      else if (m_frame.empty ())
+        {
+          m_lostFragments++; // the start of its frame was lost
+          continue;
+        }
+      m_frame.push_back (fragment.packet);
+      if (fragment.end)
+        {
+          DeliverFrame ();
+        }
+    }
+  m_reassemblyEvent.Cancel ();
+}
+
+void
+MultilinkPppNetDevice::ExpireGap (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_reassembly.empty () || m_gap != m_expected)
+    {
+      return;
+    }
+  uint64_t next = m_reassembly.begin ()->first;
+  NS_LOG_LOGIC ("fragments " << m_expected << " to " << next - 1 << " timed out");
+  m_lostFragments += next - m_expected;
+  m_expected = next;
+  DiscardFrame ();
+  Reassemble ();
+}
+
+void
+MultilinkPppNetDevice::DiscardFrame (void)
+{
+  m_lostFragments += m_frame.size ();
+  m_frame.clear ();
+}
+
+void
+MultilinkPppNetDevice::DeliverFrame (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the last fragment carries the datagram up, with its packet tags
+  Ptr<Packet> packet = m_frame.back ();
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < m_frame.size (); i++)
+    {
+      size += m_frame[i]->GetSize ();
+    }
+  m_rxFrame.resize (size);
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < m_frame.size (); i++)
+    {
+      offset += m_frame[i]->CopyData (reinterpret_cast<uint8_t *> (&m_rxFrame[offset]), size - offset);
+    }
+  m_frame.clear ();
+  if (size < 2)
+    {
+      NS_LOG_WARN ("dropping a frame without protocol number");
+      return;
+    }
+
+  const uint8_t *data = reinterpret_cast<const uint8_t *> (m_rxFrame.data ());
+  uint16_t protocol = (data[0] << 8) | data[1];
+  if (protocol == PPP_COMPRESSED)
+    {
+      if (!m_decompress)
+        {
+          NS_LOG_WARN ("dropping a compressed frame, decompression is disabled");
+          return;
+        }
+      m_zlib.Decompress (data + 2, size - 2, m_codecScratch);
+      if (m_codecScratch.size () < 2)
+        {
+          NS_LOG_WARN ("dropping a compressed frame without protocol number");
+          return;
+        }
+      PointToPointNetDevice::CodecStats &stats = m_codecStats[PointToPointNetDevice::INGRESS];
+      stats.bytesIn += size - 2;
+      stats.bytesOut += m_codecScratch.size () - 2;
+      stats.packets++;
+      data = reinterpret_cast<const uint8_t *> (m_codecScratch.data ());
+      size = m_codecScratch.size ();
+      protocol = (data[0] << 8) | data[1];
+    }
+
+  packet->RemoveAtEnd (packet->GetSize ());
+  packet->AddAtEnd (Create<Packet> (data + 2, size - 2));
+  m_reassembledFrames++;
+
+  uint16_t ethertype = protocol == PPP_IPV6 ? 0x86DD : 0x0800;
+  m_macRxTrace (packet);
+  if (!m_promiscCallback.IsNull ())
+    {
+      m_promiscCallback (this, packet, ethertype, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
+    }
+  m_rxCallback (this, packet, ethertype, GetRemote ());
+}
+
+void
+MultilinkPppNetDevice::NotifySniffer (Ptr<const Packet> packet)
+{
+  m_promiscSnifferTrace (packet);
+}
+
+Address
+MultilinkPppNetDevice::GetRemote (void) const
+{
+  NS_ASSERT (m_channel->GetNDevices () == 2);
+  for (std::size_t i = 0; i < m_channel->GetNDevices (); ++i)
+    {
+      Ptr<NetDevice> tmp = m_channel->GetDevice (i);
+      if (tmp != this)
+        {
+          return tmp->GetAddress ();
+        }
+    }
+  NS_ASSERT (false);
+  return Address ();
+}
+
+void
+MultilinkPppNetDevice::SetIfIndex (const uint32_t index)
+{
+  NS_LOG_FUNCTION (this);
+  m_ifIndex = index;
+}
+
+uint32_t
+MultilinkPppNetDevice::GetIfIndex (void) const
+{
+  return m_ifIndex;
+}
+
+Ptr<Channel>
+MultilinkPppNetDevice::GetChannel (void) const
+{
+  return m_channel;
+}
+
+void
+MultilinkPppNetDevice::SetAddress (Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_address = Mac48Address::ConvertFrom (address);
+}
+
+Address
+MultilinkPppNetDevice::GetAddress (void) const
+{
+  return m_address;
+}
+
+bool
+MultilinkPppNetDevice::SetMtu (const uint16_t mtu)
+{
+  NS_LOG_FUNCTION (this << mtu);
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t
+MultilinkPppNetDevice::GetMtu (void) const
+{
+  return m_mtu;
+}
+
+bool
+MultilinkPppNetDevice::IsLinkUp (void) const
+{
+  return m_linkUp;
+}
+
+void
+MultilinkPppNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_linkChangeCallbacks.ConnectWithoutContext (callback);
+}
+
+bool
+MultilinkPppNetDevice::IsBroadcast (void) const
+{
+  return true;
+}
+
+Address
+MultilinkPppNetDevice::GetBroadcast (void) const
+{
+  return Mac48Address ("ff:ff:ff:ff:ff:ff");
+}
+
+bool
+MultilinkPppNetDevice::IsMulticast (void) const
+{
+  return true;
+}
+
+Address
+MultilinkPppNetDevice::GetMulticast (Ipv4Address multicastGroup) const
+{
+  return Mac48Address ("01:00:5e:00:00:00");
+}
+
+Address
+MultilinkPppNetDevice::GetMulticast (Ipv6Address addr) const
+{
+  return Mac48Address ("33:33:00:00:00:00");
+}
+
+bool
+MultilinkPppNetDevice::IsPointToPoint (void) const
+{
+  return true;
+}
+
+bool
+MultilinkPppNetDevice::IsBridge (void) const
+{
+  return false;
+}
+
+bool
+MultilinkPppNetDevice::SendFrom (Ptr<Packet> packet, const Address &source, const Address &dest,
+                                 uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
+  return false;
+}
+
+Ptr<Node>
+MultilinkPppNetDevice::GetNode (void) const
+{
+  return m_node;
+}
+
+void
+MultilinkPppNetDevice::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_node = node;
+  for (uint32_t i = 0; i < m_members.size (); i++)
+    {
+      m_members[i]->SetNode (node);
+    }
+}
+
+bool
+MultilinkPppNetDevice::NeedsArp (void) const
+{
+  return false;
+}
+
+void
+MultilinkPppNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
+{
+  m_rxCallback = cb;
+}
+
+void
+MultilinkPppNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
+{
+  m_promiscCallback = cb;
+}
+
+bool
+MultilinkPppNetDevice::SupportsSendFrom (void) const
+{
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,337 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTILINK_PPP_NET_DEVICE_H
+#define MULTILINK_PPP_NET_DEVICE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/traced-callback.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "point-to-point-net-device.h"
+#include "zlib-codec.h"
+
+namespace ns3 {
+
+class MultilinkPppChannel;
+
+/**
+ * \ingroup point-to-point
+ * \brief One end of a Multilink PPP bundle of parallel point-to-point links
+ *
+ * The bundle is the interface the node routes through; its members are
+ * ordinary PointToPointNetDevices, each attached to its own
+ * PointToPointChannel, that only carry the bundle's fragments.  In the
+ * manner of RFC 1990:
+ *
+ *   - every datagram becomes a frame of its PPP protocol number followed
+ *     by the datagram, split into at most one fragment per member, none
+ *     shorter than MinFragmentSize unless the frame is;
+ *   - each fragment carries a MultilinkHeader with a sequence number and
+ *     goes, as PPP protocol 0x003d, to the member that will finish
+ *     sending it first, judged from the frame on its wire, the bytes
+ *     queued there and its data rate;
+ *   - the far end puts the fragments back in sequence order and hands up
+ *     every complete frame in order.  A member link never reorders, so a
+ *     missing sequence number lower than the last one received on every
+ *     member that is up is lost; its frame is dropped and reassembly goes
+ *     on with the next one.  A member that has gone idle would hold that
+ *     bound back, so a gap is also declared lost once it has held up the
+ *     fragments behind it for ReassemblyTimeout, or when more than
+ *     MaxReassemblyFragments fragments are waiting.
+ *
+ * With compression enabled the bundle deflates the whole frame before
+ * fragmenting it and sends the result as protocol 0x00fd, the PPP
+ * compressed datagram; the peer needs decompression enabled.  The codec
+ * runs once per datagram, not per member, so it scales with the bundle.
+ * The members' own codecs are left disabled.
+ */
+class MultilinkPppNetDevice : public NetDevice
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  MultilinkPppNetDevice ();
+  virtual ~MultilinkPppNetDevice ();
+
+  /**
+   * \brief Add a member link to the bundle
+   *
+   * The member's received frames are handed to the bundle from now on
+   * and its node is set to the bundle's.  A member need not be added to
+   * the node; if it is, add it first and give it no IP address.
+   *
+   * \param member a device attached to its own channel, whose peer is a
+   *        member of the peer bundle
+   */
+  void AddMember (Ptr<PointToPointNetDevice> member);
+
+  /**
+   * \return the number of member links
+   */
+  uint32_t GetNMembers (void) const;
+
+  /**
+   * \param i the member index, in the order they were added
+   * \return the member device
+   */
+  Ptr<PointToPointNetDevice> GetMember (uint32_t i) const;
+
+  /**
+   * \brief Attach the bundle to the logical channel shared with its peer
+   *
+   * The bundle is up once both ends are attached.
+   *
+   * \param ch the channel
+   */
+  void Attach (Ptr<MultilinkPppChannel> ch);
+
+  /**
+   * \brief Deflate every frame before fragmenting it
+   */
+  void EnableCompression (void);
+
+  /**
+   * \brief Inflate the 0x00fd frames received from the peer
+   */
+  void EnableDecompression (void);
+
+  /**
+   * \return whether frames are deflated before fragmentation
+   */
+  bool GetCompression (void) const;
+
+  /**
+   * \return whether 0x00fd frames are inflated
+   */
+  bool GetDecompression (void) const;
+
+  /**
+   * \return the deflate level, 0 when frames are sent uncompressed
+   */
+  int GetCompressionLevel (void) const;
+
+  /**
+   * \brief Get the codec counters of one direction
+   *
+   * Counts whole datagrams: bytesIn and bytesOut are the datagram and the
+   * deflated frame on egress, the other way round on ingress.
+   *
+   * \param direction EGRESS or INGRESS
+   * \return the counters since the last ResetCodec
+   */
+  PointToPointNetDevice::CodecStats GetCodecStats (PointToPointNetDevice::CodecDirection direction) const;
+
+  /**
+   * \return the number of frames deflated or inflated
+   */
+  uint64_t GetCodecPackets (void) const;
+
+  /**
+   * \return the number of fragment sequence numbers never received, or
+   *         dropped because their frame lost another fragment
+   */
+  uint64_t GetLostFragments (void) const;
+
+  /**
+   * \return the number of frames reassembled and handed up
+   */
+  uint64_t GetReassembledFrames (void) const;
+
+  /**
+   * \brief Disable the codec and zero the counters, of the bundle and its members
+   *
+   * Reassembly state is kept: sequence numbers run on across experiments.
+   */
+  void ResetCodec (void);
+
+  // The remaining methods are documented in ns3::NetDevice*
+
+  virtual void SetIfIndex (const uint32_t index);
+  virtual uint32_t GetIfIndex (void) const;
+
+  virtual Ptr<Channel> GetChannel (void) const;
+
+  virtual void SetAddress (Address address);
+  virtual Address GetAddress (void) const;
+
+  virtual bool SetMtu (const uint16_t mtu);
+  virtual uint16_t GetMtu (void) const;
+
+  virtual bool IsLinkUp (void) const;
+
+  virtual void AddLinkChangeCallback (Callback<void> callback);
+
+  virtual bool IsBroadcast (void) const;
+  virtual Address GetBroadcast (void) const;
+
+  virtual bool IsMulticast (void) const;
+  virtual Address GetMulticast (Ipv4Address multicastGroup) const;
+
+  virtual bool IsPointToPoint (void) const;
+  virtual bool IsBridge (void) const;
+
+  virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
+  virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+
+  virtual Ptr<Node> GetNode (void) const;
+  virtual void SetNode (Ptr<Node> node);
+
+  virtual bool NeedsArp (void) const;
+
+  virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+
+  virtual Address GetMulticast (Ipv6Address addr) const;
+
+  virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
+  virtual bool SupportsSendFrom (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  MultilinkPppNetDevice (const MultilinkPppNetDevice &);
+  MultilinkPppNetDevice & operator = (const MultilinkPppNetDevice &);
+
+  /// A fragment waiting for the ones before it
+  struct Fragment
+  {
+    Ptr<Packet> packet; //!< Fragment bytes, MultilinkHeader removed
+    bool begin;         //!< First fragment of its frame
+    bool end;           //!< Last fragment of its frame
+  };
+
+  /**
+   * \brief Receive callback of every member
+   * \param member the member that received the frame
+   * \param packet the frame, PPP header removed
+   * \param protocol the frame's ethertype
+   * \param from the peer member's address
+   * \return true
+   */
+  bool ReceiveFromMember (Ptr<NetDevice> member, Ptr<const Packet> packet,
+                          uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Pick the member that finishes sending a fragment first
+   *
+   * A member finishes after the rest of the frame it is sending, its
+   * queue and then the fragment.  Send makes sure a member is up.
+   *
+   * \param bytes the fragment size
+   * \return the member index, or the number of members when none is up
+   */
+  uint32_t PickMember (uint32_t bytes);
+
+  /**
+   * \brief Expand a received 24 bit sequence number around the next expected one
+   * \param sequence the sequence number from the MultilinkHeader
+   * \return the 64 bit sequence number
+   */
+  uint64_t ExtendSequence (uint32_t sequence) const;
+
+  /**
+   * \return the lowest sequence number that may still arrive on some member that is up
+   */
+  uint64_t GetLossBound (void) const;
+
+  /**
+   * \brief Consume the buffered fragments that are next in sequence
+   */
+  void Reassemble (void);
+
+  /**
+   * \brief Declare the gap at m_gap lost if reassembly is still waiting on it
+   */
+  void ExpireGap (void);
+
+  /**
+   * \brief Drop the partly reassembled frame, counting its fragments as lost
+   */
+  void DiscardFrame (void);
+
+  /**
+   * \brief Hand the reassembled frame up the stack
+   */
+  void DeliverFrame (void);
+
+  /**
+   * \brief Fire the PromiscSniffer trace for a member's frame
+   * \param packet the frame, PPP header included
+   */
+  void NotifySniffer (Ptr<const Packet> packet);
+
+  /**
+   * \return the address of the peer bundle
+   */
+  Address GetRemote (void) const;
+
+  Ptr<Node> m_node;                  //!< Node owning this bundle end
+  Ptr<MultilinkPppChannel> m_channel; //!< Logical channel to the peer bundle
+  Mac48Address m_address;            //!< Bundle address
+  uint32_t m_ifIndex;                //!< Index of the bundle on its node
+  uint16_t m_mtu;                    //!< Largest datagram sent
+  bool m_linkUp;                     //!< Both ends attached
+  NetDevice::ReceiveCallback m_rxCallback;    //!< Hands frames to the node
+  NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
+  TracedCallback<> m_linkChangeCallbacks;     //!< Link change callbacks
+
+  std::vector<Ptr<PointToPointNetDevice> > m_members; //!< Member links
+  std::vector<uint64_t> m_memberNext; //!< One past the last sequence number received on each member, 0 before any
+  uint32_t m_nextMember;             //!< Where the search for an idle member starts
+  uint32_t m_minFragmentSize;        //!< Frames are not split below this size
+  uint32_t m_maxFragments;           //!< Fragments buffered before a gap is declared lost
+  Time m_reassemblyTimeout;          //!< Wait before a gap is declared lost
+
+  uint32_t m_txSequence;             //!< Sequence number of the next fragment sent
+  uint64_t m_expected;               //!< Sequence number of the next fragment reassembled
+  std::map<uint64_t, Fragment> m_reassembly; //!< Fragments received ahead of m_expected
+  std::vector<Ptr<Packet> > m_frame; //!< Fragments of the frame being reassembled
+  uint64_t m_gap;                    //!< Sequence number the reassembly timer runs for
+  EventId m_reassemblyEvent;         //!< Reassembly timer, runs while a gap holds fragments back
+
+  bool m_compress;                   //!< Deflate egress frames
+  bool m_decompress;                 //!< Inflate ingress 0x00fd frames
+  int m_level;                       //!< Deflate level, 0 sends uncompressed
+  ZlibCodec m_zlib;                  //!< Deflate and inflate streams
+  std::string m_txFrame;             //!< Egress frame scratch buffer
+  std::string m_rxFrame;             //!< Ingress frame scratch buffer
+  std::string m_codecScratch;        //!< Codec output scratch buffer
+  PointToPointNetDevice::CodecStats m_codecStats[PointToPointNetDevice::N_DIRECTIONS]; //!< Codec counters
+  uint64_t m_lostFragments;          //!< Fragments lost or dropped
+  uint64_t m_reassembledFrames;      //!< Frames handed up
+
+  TracedCallback<Ptr<const Packet> > m_macTxTrace;        //!< Datagrams entering the bundle
+  TracedCallback<Ptr<const Packet> > m_macTxDropTrace;    //!< Datagrams dropped before a member took them
+  TracedCallback<Ptr<const Packet> > m_macRxTrace;        //!< Datagrams handed up
+  TracedCallback<Ptr<const Packet> > m_promiscSnifferTrace; //!< Member frames, both directions
+};
+
+} // namespace ns3
+
+#endif /* MULTILINK_PPP_NET_DEVICE_H */
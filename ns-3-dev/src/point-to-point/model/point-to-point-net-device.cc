@@ -24,10 +24,13 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/pointer.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
+#include "compressed-transit-tag.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/seq-ts-header.h"
@@ -80,6 +83,76 @@ namespace ns3 {
 						TimeValue (Seconds (0.0)),
 						MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
 						MakeTimeChecker ())
+				.AddAttribute ("RedundancyCacheSize",
+						"The memory budget, in bytes, of the redundancy elimination fingerprint store",
+						UintegerValue (65536),
+						MakeUintegerAccessor (&PointToPointNetDevice::SetRedundancyCacheSize,
+								&PointToPointNetDevice::GetRedundancyCacheSize),
+						MakeUintegerChecker<uint32_t> ())
+				.AddAttribute ("CompressionThreads",
+						"Number of worker threads compressing frames handed to Send "
+						"(0 compresses each frame inline in Send).  Frames enter the "
+						"queue compressed and in order either way, so simulated timing, "
+						"queue occupancy and traces are identical; with workers Send "
+						"returns true even when the queue then drops the frame.",
+						UintegerValue (0),
+						MakeUintegerAccessor (&PointToPointNetDevice::SetCompressionThreads,
+								&PointToPointNetDevice::GetCompressionThreads),
+						MakeUintegerChecker<uint32_t> ())
+				.AddAttribute ("CompressionLevel",
+						"Deflate level of compressed frames, 1 to 9, or 0 to send them "
+						"uncompressed.  With AdaptiveCompression this is the starting "
+						"level and reads back the level in use.",
+						UintegerValue (Z_BEST_COMPRESSION),
+						MakeUintegerAccessor (&PointToPointNetDevice::SetCompressionLevel,
+								&PointToPointNetDevice::GetCompressionLevel),
+						MakeUintegerChecker<uint32_t> (0, CompressionController::MAX_LEVEL))
+				.AddAttribute ("AdaptiveCompression",
+						"Choose the deflate level, or turn compression off, from the "
+						"transmit queue, the offered load against DataRate and the "
+						"modeled codec throughput (see CompressionController).  The "
+						"codec time is a model input and is not charged in simulated "
+						"time.",
+						BooleanValue (false),
+						MakeBooleanAccessor (&PointToPointNetDevice::SetAdaptiveCompression,
+								&PointToPointNetDevice::GetAdaptiveCompression),
+						MakeBooleanChecker ())
+				.AddAttribute ("CompressionControlInterval",
+						"Shortest time between two level changes of the adaptive "
+						"controller, and the window its offered load is measured over "
+						"(0 decides on every frame from the queue alone)",
+						TimeValue (MilliSeconds (10)),
+						MakeTimeAccessor (&PointToPointNetDevice::SetCompressionControlInterval,
+								&PointToPointNetDevice::GetCompressionControlInterval),
+						MakeTimeChecker ())
+				.AddAttribute ("CodecRateFast",
+						"Modeled deflate throughput at level 1, used by the adaptive controller",
+						DataRateValue (DataRate ("800Mb/s")),
+						MakeDataRateAccessor (&PointToPointNetDevice::SetCodecRateFast,
+								&PointToPointNetDevice::GetCodecRateFast),
+						MakeDataRateChecker ())
+				.AddAttribute ("CodecRateBest",
+						"Modeled deflate throughput at level 9, used by the adaptive controller",
+						DataRateValue (DataRate ("80Mb/s")),
+						MakeDataRateAccessor (&PointToPointNetDevice::SetCodecRateBest,
+								&PointToPointNetDevice::GetCodecRateBest),
+						MakeDataRateChecker ())
+				.AddAttribute ("CompressionProbeInterval",
+						"While the adaptive controller has turned compression off, one "
+						"frame in this many is still compressed at level 1 to measure "
+						"the traffic (0 never probes)",
+						UintegerValue (64),
+						MakeUintegerAccessor (&PointToPointNetDevice::SetCompressionProbeInterval,
+								&PointToPointNetDevice::GetCompressionProbeInterval),
+						MakeUintegerChecker<uint32_t> ())
+				.AddAttribute ("CompressionLevelGain",
+						"Output size reduction per deflate level, relative to the level "
+						"below, that the adaptive controller assumes for levels it has "
+						"not used yet",
+						DoubleValue (0.02),
+						MakeDoubleAccessor (&PointToPointNetDevice::SetCompressionLevelGain,
+								&PointToPointNetDevice::GetCompressionLevelGain),
+						MakeDoubleChecker<double> (0, 0.99))
 
 				//
 				// Transmit queueing discipline for the device which includes its own set
@@ -180,6 +253,15 @@ namespace ns3 {
 						"attached to the device",
 						MakeTraceSourceAccessor (&PointToPointNetDevice::m_promiscSnifferTrace),
 						"ns3::Packet::TracedCallback")
+
+				//
+				// Decisions of the adaptive compression controller.
+				//
+				.AddTraceSource ("CompressionLevelChange",
+						"The deflate level of compressed frames has changed "
+						"(0 when compression is turned off)",
+						MakeTraceSourceAccessor (&PointToPointNetDevice::m_compressionLevelTrace),
+						"ns3::PointToPointNetDevice::CompressionLevelTracedCallback")
 				;
 		return tid;
 	}
@@ -187,12 +269,18 @@ namespace ns3 {
 
 	PointToPointNetDevice::PointToPointNetDevice () 
 	:
+		m_reEncode (false),
+		m_reDecode (false),
+		m_transit (false),
+		m_transitFrames (0),
+		m_compressionThreads (0),
 		m_txMachineState (READY),
 		m_channel (0),
 		m_linkUp (false),
 		m_currentPkt (0)
 		{
 		NS_LOG_FUNCTION (this);
+		ResetCodec ();
 		}
 
 	PointToPointNetDevice::~PointToPointNetDevice ()
@@ -231,6 +319,346 @@ namespace ns3 {
 	}
   //idli
 
+	void
+	PointToPointNetDevice::EnableBidirectionalCompression (void)
+	{
+		NS_LOG_FUNCTION (this);
+		compress = true;
+		decompress = true;
+	}
+
+	void
+	PointToPointNetDevice::EnableRedundancyElimination (void)
+	{
+		NS_LOG_FUNCTION (this);
+		m_reEncode = true;
+	}
+
+	void
+	PointToPointNetDevice::EnableRedundancyRestoration (void)
+	{
+		NS_LOG_FUNCTION (this);
+		m_reDecode = true;
+	}
+
+	void
+	PointToPointNetDevice::EnableCompressedTransit (void)
+	{
+		NS_LOG_FUNCTION (this);
+		m_transit = true;
+	}
+
+	uint64_t
+	PointToPointNetDevice::GetTransitFrames (void) const
+	{
+		return m_transitFrames;
+	}
+
+	void
+	PointToPointNetDevice::SetRedundancyCacheSize (uint32_t bytes)
+	{
+		NS_LOG_FUNCTION (this << bytes);
+		m_reCache.SetBudget (bytes);
+		m_reRxCache.SetBudget (bytes);
+	}
+
+	uint32_t
+	PointToPointNetDevice::GetRedundancyCacheSize (void) const
+	{
+		return m_reCache.GetBudget ();
+	}
+
+	void
+	PointToPointNetDevice::SetCompressionThreads (uint32_t n)
+	{
+		NS_LOG_FUNCTION (this << n);
+		if (n == m_compressionThreads && (n == 0 || m_compressionPool))
+		{
+			// keep the running workers across experiments
+			return;
+		}
+		m_compressionThreads = n;
+		m_compressionPool.reset ();
+		if (n > 0)
+		{
+			m_compressionPool.reset (new CompressionWorkerPool (n));
+		}
+	}
+
+	uint32_t
+	PointToPointNetDevice::GetCompressionThreads (void) const
+	{
+		return m_compressionThreads;
+	}
+
+	void
+	PointToPointNetDevice::SetCompressionLevel (int level)
+	{
+		NS_LOG_FUNCTION (this << level);
+		m_compressionControl.SetLevel (level);
+	}
+
+	int
+	PointToPointNetDevice::GetCompressionLevel (void) const
+	{
+		return m_compressionControl.GetLevel ();
+	}
+
+	void
+	PointToPointNetDevice::SetAdaptiveCompression (bool adaptive)
+	{
+		NS_LOG_FUNCTION (this << adaptive);
+		m_compressionControl.SetAdaptive (adaptive);
+	}
+
+	bool
+	PointToPointNetDevice::GetAdaptiveCompression (void) const
+	{
+		return m_compressionControl.IsAdaptive ();
+	}
+
+	void
+	PointToPointNetDevice::SetCompressionControlInterval (Time interval)
+	{
+		NS_LOG_FUNCTION (this << interval);
+		m_compressionControl.SetInterval (interval);
+	}
+
+	Time
+	PointToPointNetDevice::GetCompressionControlInterval (void) const
+	{
+		return m_compressionControl.GetInterval ();
+	}
+
+	void
+	PointToPointNetDevice::SetCodecRateFast (DataRate rate)
+	{
+		NS_LOG_FUNCTION (this << rate);
+		m_compressionControl.SetCodecRates (rate.GetBitRate (), m_compressionControl.GetBestCodecRate ());
+	}
+
+	DataRate
+	PointToPointNetDevice::GetCodecRateFast (void) const
+	{
+		return DataRate (static_cast<uint64_t> (m_compressionControl.GetFastCodecRate ()));
+	}
+
+	void
+	PointToPointNetDevice::SetCodecRateBest (DataRate rate)
+	{
+		NS_LOG_FUNCTION (this << rate);
+		m_compressionControl.SetCodecRates (m_compressionControl.GetFastCodecRate (), rate.GetBitRate ());
+	}
+
+	DataRate
+	PointToPointNetDevice::GetCodecRateBest (void) const
+	{
+		return DataRate (static_cast<uint64_t> (m_compressionControl.GetBestCodecRate ()));
+	}
+
+	void
+	PointToPointNetDevice::SetCompressionProbeInterval (uint32_t packets)
+	{
+		NS_LOG_FUNCTION (this << packets);
+		m_compressionControl.SetProbeInterval (packets);
+	}
+
+	uint32_t
+	PointToPointNetDevice::GetCompressionProbeInterval (void) const
+	{
+		return m_compressionControl.GetProbeInterval ();
+	}
+
+	void
+	PointToPointNetDevice::SetCompressionLevelGain (double gain)
+	{
+		NS_LOG_FUNCTION (this << gain);
+		m_compressionControl.SetLevelGain (gain);
+	}
+
+	double
+	PointToPointNetDevice::GetCompressionLevelGain (void) const
+	{
+		return m_compressionControl.GetLevelGain ();
+	}
+
+	int
+	PointToPointNetDevice::ChooseCompressionLevel (uint32_t frameBytes)
+	{
+		int old = m_compressionControl.GetLevel ();
+		int level = m_compressionControl.Decide (Simulator::Now (), frameBytes, m_queue->GetNBytes (), m_bps.GetBitRate ());
+		if (m_compressionControl.GetLevel () != old)
+		{
+			m_compressionLevelTrace (old, m_compressionControl.GetLevel (), m_queue->GetNBytes ());
+		}
+		return level;
+	}
+
+	void
+	PointToPointNetDevice::SettleCompression (void)
+	{
+		while (!m_pendingCompression.empty ())
+		{
+			PendingCompression pending = m_pendingCompression.front ();
+			m_pendingCompression.pop_front ();
+			const std::string &cData = pending.job->Wait ();
+			CodecStats &stats = m_codecStats[EGRESS];
+			stats.bytesIn += pending.payloadSize;
+			stats.bytesOut += cData.size ();
+			stats.packets++;
+			RebuildPacket (pending.packet, reinterpret_cast<const uint8_t *> (cData.data ()), cData.size (),
+					pending.ipv4Header, pending.udpHeader, pending.seqTsHeader, 2049);
+			m_compressionControl.NotifyCompressed (pending.level, pending.payloadSize, cData.size ());
+			EnqueueFrame (pending.packet, false);
+		}
+	}
+
+	bool
+	PointToPointNetDevice::EnqueueFrame (Ptr<Packet> packet, bool reEncoded)
+	{
+		m_macTxTrace (packet);
+
+		//
+		// We should enqueue and dequeue the packet to hit the tracing hooks.
+		//
+		if (m_queue->Enqueue (packet))
+		{
+			if (m_queueSampler)
+			{
+				m_queueSampler->NotifyEnqueue (Simulator::Now (), m_queue->GetNPackets (), m_queue->GetNBytes ());
+			}
+			//
+			// If the channel is ready for transition we send the packet right now
+			// 
+			if (m_txMachineState == READY)
+			{
+				packet = DequeueFrame ();
+				m_snifferTrace (packet);
+				m_promiscSnifferTrace (packet);
+				bool ret = TransmitStart (packet);
+				return ret;
+			}
+			return true;
+		}
+
+		// Enqueue may fail (overflow)
+
+		if (reEncoded)
+		{
+			// the peer never sees these literals, keep the stores in step
+			m_reCache.UndoEncode ();
+		}
+		m_macTxDropTrace (packet);
+		return false;
+	}
+
+	Ptr<Packet>
+	PointToPointNetDevice::DequeueFrame (void)
+	{
+		Ptr<Packet> p = m_queue->Dequeue ();
+		if (p != 0 && m_queueSampler)
+		{
+			m_queueSampler->NotifyDequeue (Simulator::Now (), m_queue->GetNPackets (), m_queue->GetNBytes ());
+		}
+		return p;
+	}
+
+	void
+	PointToPointNetDevice::EnableQueueSampler (std::string filename, Time resolution)
+	{
+		NS_LOG_FUNCTION (this << filename << resolution);
+		m_queueSampler.reset (new QueueSampler (filename, resolution));
+	}
+
+	void
+	PointToPointNetDevice::DisableQueueSampler (void)
+	{
+		NS_LOG_FUNCTION (this);
+		m_queueSampler.reset ();
+	}
+
+	uint64_t
+	PointToPointNetDevice::GetCodecBytesIn (void) const
+	{
+		return m_codecStats[EGRESS].bytesIn;
+	}
+
+	uint64_t
+	PointToPointNetDevice::GetCodecBytesOut (void) const
+	{
+		return m_codecStats[EGRESS].bytesOut;
+	}
+
+	uint64_t
+	PointToPointNetDevice::GetCodecPackets (void) const
+	{
+		return m_codecStats[EGRESS].packets + m_codecStats[INGRESS].packets;
+	}
+
+	PointToPointNetDevice::CodecStats
+	PointToPointNetDevice::GetCodecStats (CodecDirection direction) const
+	{
+		return m_codecStats[direction];
+	}
+
+	void
+	PointToPointNetDevice::ResetCodec (void)
+	{
+		NS_LOG_FUNCTION (this);
+		NS_ASSERT_MSG (m_pendingCompression.empty (), "ResetCodec with frames still being compressed");
+		compress = false;
+		decompress = false;
+		m_reEncode = false;
+		m_reDecode = false;
+		m_transit = false;
+		m_transitFrames = 0;
+		m_reCache.Clear ();
+		m_reRxCache.Clear ();
+		for (int d = 0; d < N_DIRECTIONS; d++)
+		{
+			m_codecStats[d].packets = 0;
+			m_codecStats[d].bytesIn = 0;
+			m_codecStats[d].bytesOut = 0;
+		}
+		m_compressionControl.Reset ();
+	}
+
+	void
+	PointToPointNetDevice::ExtractPayload (Ptr<Packet> p, Ipv4Header &ipv4Header,
+			UdpHeader &udpHeader, SeqTsHeader &seqTsHeader, std::string &payload)
+	{
+		PppHeader ppp;
+		p->RemoveHeader (ppp);
+		p->RemoveHeader (ipv4Header);
+		p->RemoveHeader (udpHeader);
+		p->RemoveHeader (seqTsHeader);
+
+		payload.resize (p->GetSize ());
+		if (!payload.empty ())
+		{
+			p->CopyData (reinterpret_cast<uint8_t *> (&payload[0]), payload.size ());
+		}
+	}
+
+	void
+	PointToPointNetDevice::RebuildPacket (Ptr<Packet> p, const uint8_t *payload, uint32_t size,
+			Ipv4Header &ipv4Header, UdpHeader &udpHeader, const SeqTsHeader &seqTsHeader,
+			uint16_t protocolNumber)
+	{
+		p->RemoveAtEnd (p->GetSize ());
+		p->AddAtEnd (Create<Packet> (payload, size));
+
+		p -> AddHeader(seqTsHeader);
+
+		udpHeader.ForcePayloadSize(p -> GetSize ());
+		p -> AddHeader(udpHeader);
+
+		ipv4Header.SetPayloadSize(p -> GetSize ());
+		p -> AddHeader(ipv4Header);
+
+		AddHeader (p, protocolNumber);
+	}
+
 	bool
 	PointToPointNetDevice::ProcessHeader (Ptr<Packet> p, uint16_t& param)
 	{
@@ -250,6 +678,10 @@ namespace ns3 {
 		m_receiveErrorModel = 0;
 		m_currentPkt = 0;
 		m_queue = 0;
+		m_settleEvent.Cancel ();
+		m_pendingCompression.clear ();
+		m_compressionPool.reset ();
+		m_queueSampler.reset ();
 		NetDevice::DoDispose ();
 	}
 
@@ -260,6 +692,12 @@ namespace ns3 {
 		m_bps = bps;
 	}
 
+	DataRate
+	PointToPointNetDevice::GetDataRate (void) const
+	{
+		return m_bps;
+	}
+
 	void
 	PointToPointNetDevice::SetInterframeGap (Time t)
 	{
@@ -286,6 +724,12 @@ namespace ns3 {
 		Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
 		Time txCompleteTime = txTime + m_tInterframeGap;
 
+		// The channel copies the packet now, so the serialization time is
+		// charged up front rather than in TransmitComplete.
+		LatencyTag::StampPacket (p, LatencyTag::QUEUE, Simulator::Now ());
+		LatencyTag::StampPacket (p, LatencyTag::SERIALIZATION, Simulator::Now () + txTime);
+
+		m_txCompleteTime = Simulator::Now () + txCompleteTime;
 		NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
 		Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
 
@@ -309,6 +753,9 @@ namespace ns3 {
 		// next packet.
 		//
 		NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
+
+		// frames still with the workers were sent while the link was busy
+		SettleCompression ();
 		m_txMachineState = READY;
 
 		NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
@@ -316,7 +763,7 @@ namespace ns3 {
 		m_phyTxEndTrace (m_currentPkt);
 		m_currentPkt = 0;
 
-		Ptr<Packet> p = m_queue->Dequeue ();
+		Ptr<Packet> p = DequeueFrame ();
 		if (p == 0)
 		{
 			NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -393,6 +840,8 @@ namespace ns3 {
 			// more complicated devices.
 			//
 
+			LatencyTag::StampPacket (packet, LatencyTag::PROPAGATION, Simulator::Now ());
+
 			// idli
 
 			PppHeader ppp;
@@ -405,44 +854,42 @@ namespace ns3 {
 				UdpHeader udpHeader;
 				SeqTsHeader seqTsHeader;
 
-				packet->RemoveHeader(ppp);
-
-				packet->RemoveHeader(ipv4Header);
-
-				packet->RemoveHeader(udpHeader);
-
-				packet->RemoveHeader(seqTsHeader);
-
-				uint8_t *buffer = new uint8_t[packet->GetSize ()];
-        /*instead*/packet->CopyData(buffer, packet->GetSize ());
-				std::string cData = std::string(buffer, buffer+packet->GetSize());
+				ExtractPayload (packet, ipv4Header, udpHeader, seqTsHeader, m_payloadScratch);
+				CompressedTransitTag transitTag;
+				packet->RemovePacketTag (transitTag);
 	
 				// uncompressing data 
 
-				std::string ucData = zlib_decompress_string(cData);
-
-				std::string protocolData = ucData.substr(0, 6);
-				std::string originalData = ucData.substr(protocolData.length(),ucData.length());
+				m_zlib.Decompress (reinterpret_cast<const uint8_t *> (m_payloadScratch.data ()), m_payloadScratch.size (), m_codecScratch);
 
-				//creating new packet
-				Ptr<Packet> newPacket = Create<Packet> (reinterpret_cast<const uint8_t*> (originalData.c_str()),originalData.length());
-
-
-				newPacket -> AddHeader(seqTsHeader);
-
-				udpHeader.ForcePayloadSize(newPacket -> GetSize ());
-				newPacket -> AddHeader(udpHeader);
-
-				ipv4Header.SetPayloadSize(newPacket -> GetSize ());
-				newPacket -> AddHeader(ipv4Header);
-
-				AddHeader (newPacket, 2048); //idli
-
-				packet = newPacket;
+				// skip the 6 byte "0x0021" protocol string in front of the original data
+				uint32_t protocolLength = std::min<uint32_t> (6, m_codecScratch.size ());
+				CodecStats &stats = m_codecStats[INGRESS];
+				stats.bytesIn += m_payloadScratch.size ();
+				stats.bytesOut += m_codecScratch.size () - protocolLength;
+				stats.packets++;
+				RebuildPacket (packet, reinterpret_cast<const uint8_t *> (m_codecScratch.data ()) + protocolLength,
+						m_codecScratch.size () - protocolLength, ipv4Header, udpHeader, seqTsHeader, 2048); //idli
 
 			} 
 			//  idli    
 
+			else if (m_reDecode && ppp.GetProtocol () == 0x4023)
+			{
+				Ipv4Header ipv4Header;
+				UdpHeader udpHeader;
+				SeqTsHeader seqTsHeader;
+
+				ExtractPayload (packet, ipv4Header, udpHeader, seqTsHeader, m_payloadScratch);
+				m_reRxCache.Decode (m_payloadScratch, m_codecScratch);
+				CodecStats &stats = m_codecStats[INGRESS];
+				stats.bytesIn += m_payloadScratch.size ();
+				stats.bytesOut += m_codecScratch.size ();
+				stats.packets++;
+
+				RebuildPacket (packet, reinterpret_cast<const uint8_t *> (m_codecScratch.data ()), m_codecScratch.size (),
+						ipv4Header, udpHeader, seqTsHeader, 0x0800);
+			}
 
 			m_snifferTrace (packet);
 			m_promiscSnifferTrace (packet);
@@ -465,6 +912,18 @@ namespace ns3 {
 
 			ProcessHeader (packet, protocol);
 
+			if (m_transit && !decompress && ppp.GetProtocol () == 0x4021)
+			{
+				//
+				// Leave the payload deflated; the node routes the datagram on its
+				// IPv4 header and the tag makes the next device send it as 0x4021.
+				//
+				CompressedTransitTag transitTag;
+				packet->PeekPacketTag (transitTag);
+				transitTag.SetHops (transitTag.GetHops () + 1);
+				packet->ReplacePacketTag (transitTag);
+			}
+
 			if (!m_promiscCallback.IsNull ())
 			{
 				m_macPromiscRxTrace (originalPacket);
@@ -484,6 +943,16 @@ namespace ns3 {
 		return m_queue;
 	}
 
+	Time
+	PointToPointNetDevice::GetTransmitRemaining (void) const
+	{
+		if (m_txMachineState != BUSY)
+		{
+			return Time (0);
+		}
+		return m_txCompleteTime - Simulator::Now ();
+	}
+
 	void
 	PointToPointNetDevice::NotifyLinkUp (void)
 	{
@@ -623,6 +1092,30 @@ namespace ns3 {
 			return false;
 		}
 
+		LatencyTag::StampPacket (packet, LatencyTag::STACK, Simulator::Now ());
+
+		//
+		// Frames with the workers go first.  A fixed level does not depend on
+		// the queue, so more frames may join them; the adaptive controller
+		// reads the queue and needs it settled.
+		//
+		if (!m_compressionPool || m_compressionControl.IsAdaptive ())
+		{
+			SettleCompression ();
+		}
+
+		//
+		// A datagram received compressed in transit goes out compressed, past
+		// the codecs below.
+		//
+		CompressedTransitTag transitTag;
+		if (protocolNumber == 0x0800 && packet->PeekPacketTag (transitTag))
+		{
+			protocolNumber = 0x0801;
+			// counted on egress only, so a router adds one per frame
+			m_transitFrames++;
+		}
+
 		//
 		// Stick a point to point protocol header on the packet in preparation for
 		// shoving it out the door.
@@ -633,78 +1126,88 @@ namespace ns3 {
 		PppHeader ppp;
 		packet->PeekHeader(ppp);
 
-		if (compress == true && ppp.GetProtocol() == 33) { //checking if the packet has to be compressed and protocol is 0X0021
+		// deflate level of this frame, 0 when the controller sends it as is
+		int level = 0;
+		// the fingerprint store took this frame's literals
+		bool reEncoded = false;
+		if (compress == true && ppp.GetProtocol() == 33)
+		{
+			level = ChooseCompressionLevel (packet->GetSize ());
+		}
+
+		if (level > 0 && m_compressionPool) {
+			//
+			// Hand the payload to the workers and hold the frame back.  It is
+			// rebuilt and queued at its compressed size by SettleCompression,
+			// before the device next uses its queue and at the latest in an
+			// event of the current time step, so the queue, the traces and the
+			// timing are those of the inline path.
+			//
+			PendingCompression pending;
+			ExtractPayload (packet, pending.ipv4Header, pending.udpHeader, pending.seqTsHeader, m_payloadScratch);
+			pending.packet = packet;
+			pending.payloadSize = m_payloadScratch.size ();
+			pending.level = level;
+			pending.job = m_compressionPool->Submit ("0x0021" + m_payloadScratch, level);
+			m_pendingCompression.push_back (pending);
+			if (!m_settleEvent.IsRunning ())
+			{
+				m_settleEvent = Simulator::ScheduleNow (&PointToPointNetDevice::SettleCompression, this);
+			}
+			return true;
+		}
+
+		// any other frame queues behind those with the workers
+		SettleCompression ();
+
+		if (level > 0) { //checking if the packet has to be compressed and protocol is 0X0021
 
 			//declaring header variables
 			Ipv4Header ipv4Header;
 			UdpHeader udpHeader;
 			SeqTsHeader seqTsHeader;
 
-			packet->RemoveHeader(ppp);
-
-			packet->RemoveHeader(ipv4Header);
-
-			packet->RemoveHeader(udpHeader);
-
-			packet->RemoveHeader(seqTsHeader);
-
 			//getting data from packet //
-			uint8_t *buffer = new uint8_t[packet->GetSize () ];
-			std::string data = std::string(buffer, buffer+packet->GetSize());
+			ExtractPayload (packet, ipv4Header, udpHeader, seqTsHeader, m_payloadScratch);
 
-			std::string protocol = "0x0021";
-			std::string ucData  = protocol+data;// data
+			static const std::string protocol = "0x0021";
 
 			////
-			// compress Data
-
-			std::string cData = zlib_compress_string(ucData);
-
-
-			//creating new packet
-			Ptr<Packet> newPacket = Create<Packet> ((reinterpret_cast<const uint8_t*> (cData.c_str())),cData.length());
-
-			newPacket -> AddHeader(seqTsHeader);
-
-			udpHeader.ForcePayloadSize(newPacket -> GetSize ());
-			newPacket -> AddHeader(udpHeader);
-
-			ipv4Header.SetPayloadSize(newPacket -> GetSize ());
-			newPacket -> AddHeader(ipv4Header);
+			// compress Data, prefixed with the protocol string
 
+			m_zlib.SetLevel (level);
+			m_zlib.Compress (protocol, reinterpret_cast<const uint8_t *> (m_payloadScratch.data ()), m_payloadScratch.size (), m_codecScratch);
+			CodecStats &stats = m_codecStats[EGRESS];
+			stats.bytesIn += m_payloadScratch.size ();
+			stats.bytesOut += m_codecScratch.size ();
+			stats.packets++;
 
-			AddHeader (newPacket, 2049); //idli
-
-			packet = newPacket;
+			RebuildPacket (packet, reinterpret_cast<const uint8_t *> (m_codecScratch.data ()), m_codecScratch.size (),
+					ipv4Header, udpHeader, seqTsHeader, 2049); //idli
+			m_compressionControl.NotifyCompressed (level, m_payloadScratch.size (), m_codecScratch.size ());
 
 		}
 		//idli
 
-		m_macTxTrace (packet);
-
-		//
-		// We should enqueue and dequeue the packet to hit the tracing hooks.
-		//
-		if (m_queue->Enqueue (packet))
+		else if (m_reEncode && ppp.GetProtocol () == 0x0021)
 		{
-			//
-			// If the channel is ready for transition we send the packet right now
-			// 
-			if (m_txMachineState == READY)
-			{
-				packet = m_queue->Dequeue ();
-				m_snifferTrace (packet);
-				m_promiscSnifferTrace (packet);
-				bool ret = TransmitStart (packet);
-				return ret;
-			}
-			return true;
-		}
+			Ipv4Header ipv4Header;
+			UdpHeader udpHeader;
+			SeqTsHeader seqTsHeader;
 
-		// Enqueue may fail (overflow)
+			ExtractPayload (packet, ipv4Header, udpHeader, seqTsHeader, m_payloadScratch);
+			m_reCache.Encode (m_payloadScratch, m_codecScratch);
+			reEncoded = true;
+			CodecStats &stats = m_codecStats[EGRESS];
+			stats.bytesIn += m_payloadScratch.size ();
+			stats.bytesOut += m_codecScratch.size ();
+			stats.packets++;
 
-		m_macTxDropTrace (packet);
-		return false;
+			RebuildPacket (packet, reinterpret_cast<const uint8_t *> (m_codecScratch.data ()), m_codecScratch.size (),
+					ipv4Header, udpHeader, seqTsHeader, 0x0802);
+		}
+
+		return EnqueueFrame (packet, reEncoded);
 	}
 
 	bool
@@ -805,7 +1308,9 @@ namespace ns3 {
 		{
 		case 0x0021: return 0x0800;   //IPv4
 		case 0x4021 : return 0x0800;   // idli - compress but IPv4
+		case 0x4023: return 0x0800;   //IPv4 redundancy eliminated
 		case 0x0057: return 0x86DD;   //IPv6
+		case 0x003d: return 0x0803;   //Multilink PPP fragment
 		default: NS_ASSERT_MSG (false, "PPP Protocol number not defined1!");
 		}
 		return 0;
@@ -819,7 +1324,9 @@ namespace ns3 {
 		{
 		case 0x0800: return 0x0021;   //IPv4
 		case 0x0801: return 0x4021;   //IPv4 compressed //idli
+		case 0x0802: return 0x4023;   //IPv4 redundancy eliminated
 		case 0x86DD: return 0x0057;   //IPv6
+		case 0x0803: return 0x003d;   //Multilink PPP fragment
 		default: NS_ASSERT_MSG (false, "PPP Protocol number not defined2!");
 		}
 		return 0;
@@ -20,6 +20,8 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <deque>
+#include <memory>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -27,9 +29,19 @@
 #include "ns3/packet.h"
 #include "ns3/traced-callback.h"
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/latency-tag.h"
+#include "redundancy-elimination-cache.h"
+#include "compression-worker-pool.h"
+#include "zlib-codec.h"
+#include "queue-sampler.h"
+#include "compression-controller.h"
 
 namespace ns3 {
 
@@ -86,6 +98,137 @@ public:
         
 //idli
 
+  /**
+   * \brief Compress egress and decompress ingress frames on this device
+   *
+   * Enable it on both ends of a link for full-duplex compression.  The
+   * two directions share nothing: deflate and inflate use their own zlib
+   * streams, and GetCodecStats keeps separate counters for each.
+   */
+  void EnableBidirectionalCompression (void);
+
+  /**
+   * \brief Replace payload chunks already seen on the link by fingerprints
+   *
+   * The peer device must have redundancy restoration enabled.  Encoded
+   * packets are sent with PPP protocol number 0x4023.
+   */
+  void EnableRedundancyElimination (void);
+
+  /**
+   * \brief Rebuild payloads of packets received with PPP protocol 0x4023
+   *
+   * Restoration uses its own fingerprint store, mirroring the encoder of
+   * the peer, so a device may eliminate and restore at the same time.
+   */
+  void EnableRedundancyRestoration (void);
+
+  /// Direction of the frames a codec works on
+  enum CodecDirection
+  {
+    EGRESS = 0,     //!< Frames sent by this device
+    INGRESS,        //!< Frames received by this device
+    N_DIRECTIONS
+  };
+
+  /// Codec counters of one direction
+  struct CodecStats
+  {
+    uint64_t packets;  //!< Frames compressed, eliminated, decompressed or restored
+    uint64_t bytesIn;  //!< Payload bytes handed to the codec
+    uint64_t bytesOut; //!< Payload bytes produced by the codec
+  };
+
+  /**
+   * \brief Get the codec counters of one direction
+   *
+   * On egress bytesIn is the original payload and bytesOut the encoded
+   * one; on ingress bytesIn is the encoded payload received and bytesOut
+   * the payload rebuilt from it.
+   *
+   * \param direction EGRESS or INGRESS
+   * \return the counters since the last ResetCodec
+   */
+  CodecStats GetCodecStats (CodecDirection direction) const;
+
+  /**
+   * \brief Forward compressed frames across this device without expanding them
+   *
+   * PPP 0x4021 frames received while decompression is off are handed up
+   * as IPv4 with a CompressedTransitTag, and tagged datagrams sent through
+   * this device leave as 0x4021 frames untouched, whatever its own codec
+   * settings.  Enable it on every device inside a compression domain; the
+   * device at the egress of the domain enables decompression instead.
+   */
+  void EnableCompressedTransit (void);
+
+  /**
+   * \brief Get the number of compressed frames forwarded without expansion
+   * \return the number of 0x4021 frames this device sent on in transit
+   */
+  uint64_t GetTransitFrames (void) const;
+
+  /**
+   * \brief Get the number of payload bytes handed to the egress codec
+   * \return the number of payload bytes before compression or elimination
+   */
+  uint64_t GetCodecBytesIn (void) const;
+
+  /**
+   * \brief Get the number of payload bytes produced by the egress codec
+   * \return the number of payload bytes after compression or elimination
+   */
+  uint64_t GetCodecBytesOut (void) const;
+
+  /**
+   * \brief Get the number of frames rebuilt by the codec path
+   * \return the number of frames compressed, decompressed or restored
+   */
+  uint64_t GetCodecPackets (void) const;
+
+  /**
+   * \brief Get the deflate level applied to the next frame
+   * \return 1 to 9, or 0 while compression is turned off by the controller
+   */
+  int GetCompressionLevel (void) const;
+
+  /**
+   * TracedCallback signature for compression level changes.
+   *
+   * \param [in] oldLevel the level used so far, 0 for no compression
+   * \param [in] newLevel the level used from now on
+   * \param [in] queueBytes bytes in the transmit queue when it changed
+   */
+  typedef void (* CompressionLevelTracedCallback)
+    (int32_t oldLevel, int32_t newLevel, uint32_t queueBytes);
+
+  /**
+   * \brief Return the codec path to its freshly constructed state
+   *
+   * Compression, decompression, compressed transit and redundancy
+   * elimination are disabled,
+   * the fingerprint store is emptied, the codec counters are zeroed and
+   * the compression level controller forgets what it observed.
+   * The zlib streams and scratch buffers are kept for the next run.
+   * Only call this while no frame is queued on the device.
+   */
+  void ResetCodec (void);
+
+  /**
+   * \brief Record the transmit queue length and sojourn times to a file
+   *
+   * Replaces any sampler already running on the device.
+   *
+   * \param filename the binary time series to create, see QueueSampler
+   * \param resolution the length of a sampling interval
+   */
+  void EnableQueueSampler (std::string filename, Time resolution);
+
+  /**
+   * \brief Flush and close the queue sampler, if any
+   */
+  void DisableQueueSampler (void);
+
   /**
    * Destroy a PointToPointNetDevice
    *
@@ -102,6 +245,11 @@ public:
    */
   void SetDataRate (DataRate bps);
 
+  /**
+   * \return the data rate at which this object operates
+   */
+  DataRate GetDataRate (void) const;
+
   /**
    * Set the interframe gap used to separate packets.  The interframe gap
    * defines the minimum space required between packets sent by this device.
@@ -135,6 +283,14 @@ public:
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /**
+   * \brief Get the time left before the transmitter is ready again
+   *
+   * \returns the rest of the frame being sent and its interframe gap, zero
+   *          when the transmitter is idle
+   */
+  Time GetTransmitRemaining (void) const;
+
   /**
    * Attach a receive ErrorModel to the PointToPointNetDevice.
    *
@@ -241,6 +397,209 @@ private:
 
         //idli
 
+  bool m_reEncode; //!< Eliminate redundant payload chunks on egress
+  bool m_reDecode; //!< Restore redundant payload chunks on ingress
+  bool m_transit;  //!< Forward 0x4021 frames without decompressing them
+  uint64_t m_transitFrames; //!< Compressed frames sent on in transit
+  RedundancyEliminationCache m_reCache;   //!< Egress fingerprint store, mirrored by the peer's decoder
+  RedundancyEliminationCache m_reRxCache; //!< Ingress fingerprint store, mirroring the peer's encoder
+  CodecStats m_codecStats[N_DIRECTIONS];  //!< Codec counters per direction
+  ZlibCodec m_zlib;            //!< Inline deflate/inflate streams
+  std::string m_payloadScratch; //!< Payload extracted from a frame
+  std::string m_codecScratch;   //!< Payload produced by a codec
+
+  /**
+   * A frame whose payload is being compressed by the worker pool, held
+   * back until SettleCompression queues it.
+   */
+  struct PendingCompression
+  {
+    Ptr<Packet> packet;                   //!< The frame, stripped to its payload
+    Ipv4Header ipv4Header;                //!< IPv4 header of the frame
+    UdpHeader udpHeader;                  //!< UDP header of the frame
+    SeqTsHeader seqTsHeader;              //!< SeqTs header of the frame
+    uint32_t payloadSize;                 //!< Uncompressed payload size
+    int level;                            //!< Deflate level of the job
+    std::shared_ptr<CompressionJob> job;  //!< Compression in progress
+  };
+
+  uint32_t m_compressionThreads; //!< Worker threads used for deflate, 0 to compress inline
+  std::unique_ptr<CompressionWorkerPool> m_compressionPool; //!< Deflate workers
+  std::deque<PendingCompression> m_pendingCompression; //!< Frames with the workers, in Send order
+  EventId m_settleEvent;         //!< Queues the frames with the workers by the end of the time step
+
+  /**
+   * \brief Set the number of threads compressing the frames handed to Send
+   * \param n number of worker threads, 0 to compress in Send
+   */
+  void SetCompressionThreads (uint32_t n);
+
+  /**
+   * \brief Get the number of threads compressing the frames handed to Send
+   * \return number of worker threads
+   */
+  uint32_t GetCompressionThreads (void) const;
+
+  CompressionController m_compressionControl; //!< Chooses the deflate level
+
+  /**
+   * The trace source fired when the compression level controller moves to
+   * another level.
+   */
+  TracedCallback<int32_t, int32_t, uint32_t> m_compressionLevelTrace;
+
+  /**
+   * \brief Choose the deflate level of a frame about to be compressed
+   *
+   * Fires the CompressionLevelChange trace when the controller adopts a
+   * new level.
+   *
+   * \param frameBytes size of the uncompressed frame
+   * \return the level to use, 0 to send the frame uncompressed
+   */
+  int ChooseCompressionLevel (uint32_t frameBytes);
+
+  /**
+   * \brief Set the fixed deflate level, or the starting level when adaptive
+   * \param level 0 for no compression, 1 to 9
+   */
+  void SetCompressionLevel (int level);
+
+  /**
+   * \brief Choose the deflate level from the link state
+   * \param adaptive true for the adaptive controller, false for a fixed level
+   */
+  void SetAdaptiveCompression (bool adaptive);
+
+  /**
+   * \return whether the deflate level is chosen from the link state
+   */
+  bool GetAdaptiveCompression (void) const;
+
+  /**
+   * \brief Set how often the adaptive controller may change level
+   * \param interval the control interval, zero to decide per frame
+   */
+  void SetCompressionControlInterval (Time interval);
+
+  /**
+   * \return the control interval of the adaptive controller
+   */
+  Time GetCompressionControlInterval (void) const;
+
+  /**
+   * \param rate modeled deflate throughput at level 1
+   */
+  void SetCodecRateFast (DataRate rate);
+
+  /**
+   * \return modeled deflate throughput at level 1
+   */
+  DataRate GetCodecRateFast (void) const;
+
+  /**
+   * \param rate modeled deflate throughput at level 9
+   */
+  void SetCodecRateBest (DataRate rate);
+
+  /**
+   * \return modeled deflate throughput at level 9
+   */
+  DataRate GetCodecRateBest (void) const;
+
+  /**
+   * \param packets frames between probes while compression is off
+   */
+  void SetCompressionProbeInterval (uint32_t packets);
+
+  /**
+   * \return frames between probes while compression is off
+   */
+  uint32_t GetCompressionProbeInterval (void) const;
+
+  /**
+   * \param gain output size reduction per level assumed for unused levels
+   */
+  void SetCompressionLevelGain (double gain);
+
+  /**
+   * \return the output size reduction per level assumed for unused levels
+   */
+  double GetCompressionLevelGain (void) const;
+
+  /**
+   * \brief Queue the frames handed to the worker pool, in Send order
+   *
+   * Waits for each job (or runs it), rebuilds the frame that Send would
+   * have built inline and queues it as Send would have.  Called before
+   * the device next uses its queue, and from an event scheduled for the
+   * time the frames were sent.
+   */
+  void SettleCompression (void);
+
+  /**
+   * \brief Queue a finished frame, and start sending it if the link is idle
+   * \param packet the frame, PPP header included
+   * \param reEncoded the fingerprint store took the frame's literals
+   * \return false if the queue dropped the frame
+   */
+  bool EnqueueFrame (Ptr<Packet> packet, bool reEncoded);
+
+  /**
+   * \brief Take the next frame off the transmit queue
+   *
+   * Reports the dequeue to the queue sampler.
+   *
+   * \return the frame to transmit, null if the queue is empty
+   */
+  Ptr<Packet> DequeueFrame (void);
+
+  std::unique_ptr<QueueSampler> m_queueSampler; //!< Transmit queue time series, null when off
+
+  /**
+   * \brief Set the memory budget of the redundancy elimination store
+   * \param bytes the budget in bytes
+   */
+  void SetRedundancyCacheSize (uint32_t bytes);
+
+  /**
+   * \brief Get the memory budget of the redundancy elimination store
+   * \return the budget in bytes
+   */
+  uint32_t GetRedundancyCacheSize (void) const;
+
+  /**
+   * \brief Strip the PPP, IPv4, UDP and SeqTs headers off a packet
+   * \param p the packet, left holding only the application payload
+   * \param ipv4Header receives the IPv4 header
+   * \param udpHeader receives the UDP header
+   * \param seqTsHeader receives the SeqTs header
+   * \param payload receives a copy of the application payload
+   */
+  void ExtractPayload (Ptr<Packet> p, Ipv4Header &ipv4Header,
+                       UdpHeader &udpHeader, SeqTsHeader &seqTsHeader,
+                       std::string &payload);
+
+  /**
+   * \brief Rebuild a PPP frame around a (re)encoded payload
+   *
+   * Whatever p still holds is dropped and the payload is appended as a
+   * new Packet, so every rebuild allocates a Packet and its Buffer; only
+   * p itself, with its packet tags, is kept.  The headers are then added
+   * back in front.
+   *
+   * \param p the packet to rebuild
+   * \param payload pointer to the application payload
+   * \param size size of the application payload
+   * \param ipv4Header the IPv4 header, its payload size is updated
+   * \param udpHeader the UDP header, its payload size is updated
+   * \param seqTsHeader the SeqTs header
+   * \param protocolNumber the Ethernet protocol number mapped to PPP
+   */
+  void RebuildPacket (Ptr<Packet> p, const uint8_t *payload, uint32_t size,
+                      Ipv4Header &ipv4Header, UdpHeader &udpHeader,
+                      const SeqTsHeader &seqTsHeader, uint16_t protocolNumber);
+
   /**
    * \returns the address of the remote device connected to this device
    * through the point to point channel.
@@ -310,6 +669,11 @@ private:
    */
   TxMachineState m_txMachineState;
 
+  /**
+   * When the transmitter becomes ready again, valid while it is BUSY.
+   */
+  Time m_txCompleteTime;
+
   /**
    * The data rate that the Net Device uses to simulate packet transmission
    * timing.
@@ -67,9 +67,15 @@ PppHeader::Print (std::ostream &os) const
  case 0x4021: /* IPv4 compression */ //idli
       proto = "IP (0x4021)";
       break;
+    case 0x4023: /* IPv4 redundancy elimination */
+      proto = "IP (0x4023)";
+      break;
     case 0x0057: /* IPv6 */
       proto = "IPv6 (0x0057)";
       break;
+    case 0x003d: /* Multilink PPP fragment */
+      proto = "MP (0x003d)";
+      break;
     default:
       NS_ASSERT_MSG (false, "PPP Protocol number not defined!");
     }
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "queue-sampler.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QueueSampler");
+
+namespace {
+
+template <typename T>
+void
+Append (std::vector<uint8_t> &buffer, T value)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *> (&value);
+  buffer.insert (buffer.end (), bytes, bytes + sizeof (T));
+}
+
+} // anonymous namespace
+
+QueueSampler::QueueSampler (const std::string &filename, Time resolution)
+  : m_resolution (std::max<int64_t> (resolution.GetNanoSeconds (), 1)),
+    m_interval (-1),
+    m_packets (0),
+    m_bytes (0),
+    m_sojournSum (0),
+    m_sojournMax (0),
+    m_dequeues (0)
+{
+  NS_LOG_FUNCTION (this << filename << resolution);
+  m_file = std::fopen (filename.c_str (), "wb");
+  NS_ABORT_MSG_IF (m_file == 0, "QueueSampler: cannot open " << filename);
+  m_buffer.reserve (BUFFER_RECORDS * 24);
+  m_buffer.insert (m_buffer.end (), "QSMP", "QSMP" + 4);
+  Append<uint32_t> (m_buffer, 1);
+  Append<int64_t> (m_buffer, m_resolution);
+}
+
+QueueSampler::~QueueSampler ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  std::fclose (m_file);
+}
+
+void
+QueueSampler::Advance (int64_t now)
+{
+  int64_t interval = now - now % m_resolution;
+  if (interval != m_interval)
+    {
+      if (m_interval >= 0)
+        {
+          Emit ();
+        }
+      m_interval = interval;
+    }
+}
+
+void
+QueueSampler::Emit (void)
+{
+  Append<int64_t> (m_buffer, m_interval);
+  Append<uint32_t> (m_buffer, m_packets);
+  Append<uint32_t> (m_buffer, m_bytes);
+  Append<uint32_t> (m_buffer, m_dequeues ? m_sojournSum / m_dequeues / 1000 : 0);
+  Append<uint32_t> (m_buffer, m_sojournMax / 1000);
+  m_sojournSum = 0;
+  m_sojournMax = 0;
+  m_dequeues = 0;
+  if (m_buffer.size () >= BUFFER_RECORDS * 24)
+    {
+      std::fwrite (m_buffer.data (), 1, m_buffer.size (), m_file);
+      m_buffer.clear ();
+    }
+}
+
+void
+QueueSampler::NotifyEnqueue (Time now, uint32_t packets, uint32_t bytes)
+{
+  int64_t t = now.GetNanoSeconds ();
+  Advance (t);
+  m_arrivals.push_back (t);
+  m_packets = packets;
+  m_bytes = bytes;
+}
+
+void
+QueueSampler::NotifyDequeue (Time now, uint32_t packets, uint32_t bytes)
+{
+  int64_t t = now.GetNanoSeconds ();
+  Advance (t);
+  if (!m_arrivals.empty ())
+    {
+      uint64_t sojourn = t - m_arrivals.front ();
+      m_arrivals.pop_front ();
+      m_sojournSum += sojourn;
+      m_sojournMax = std::max (m_sojournMax, sojourn);
+      m_dequeues++;
+    }
+  m_packets = packets;
+  m_bytes = bytes;
+}
+
+void
+QueueSampler::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_interval >= 0)
+    {
+      Emit ();
+      m_interval = -1;
+    }
+  std::fwrite (m_buffer.data (), 1, m_buffer.size (), m_file);
+  m_buffer.clear ();
+  std::fflush (m_file);
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUEUE_SAMPLER_H
+#define QUEUE_SAMPLER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Binary time series of a device transmit queue.
+ *
+ * The device reports every enqueue and dequeue.  Time is cut into
+ * intervals of the configured resolution and one record is written for
+ * each interval in which the queue changed; intervals without a record
+ * keep the previous queue length.  No event is scheduled, so a sampler
+ * costs a few arithmetic operations per packet.
+ *
+ * File layout, all fields little endian as written by the host:
+ *
+ *   - header:  "QSMP", uint32 version (1), int64 resolution in ns
+ *   - records: int64 interval start in ns, uint32 packets and uint32
+ *     bytes in the queue at the end of the interval, uint32 mean and
+ *     uint32 max sojourn in us of the packets dequeued in the interval
+ */
+class QueueSampler
+{
+public:
+  /**
+   * \param filename the file to create
+   * \param resolution the length of a sampling interval
+   */
+  QueueSampler (const std::string &filename, Time resolution);
+  ~QueueSampler ();
+
+  /**
+   * \brief Report a packet entering the queue
+   * \param now the current time
+   * \param packets the queue length in packets after the enqueue
+   * \param bytes the queue length in bytes after the enqueue
+   */
+  void NotifyEnqueue (Time now, uint32_t packets, uint32_t bytes);
+
+  /**
+   * \brief Report the packet at the head of the queue leaving it
+   * \param now the current time
+   * \param packets the queue length in packets after the dequeue
+   * \param bytes the queue length in bytes after the dequeue
+   */
+  void NotifyDequeue (Time now, uint32_t packets, uint32_t bytes);
+
+  /**
+   * \brief Write the current interval and every buffered record
+   */
+  void Flush (void);
+
+private:
+  QueueSampler (const QueueSampler &);
+  QueueSampler & operator = (const QueueSampler &);
+
+  /**
+   * \brief Close the current interval if now is past its end
+   * \param now the current time
+   */
+  void Advance (int64_t now);
+
+  /// Emit the record of the current interval
+  void Emit (void);
+
+  static const uint32_t BUFFER_RECORDS = 4096; //!< Records written per fwrite
+
+  std::FILE *m_file;          //!< Output file
+  int64_t m_resolution;       //!< Interval length in ns
+  int64_t m_interval;         //!< Start of the current interval in ns, -1 if none
+  uint32_t m_packets;         //!< Queue length in packets at the last event
+  uint32_t m_bytes;           //!< Queue length in bytes at the last event
+  uint64_t m_sojournSum;      //!< Sojourn of the interval's dequeues in ns
+  uint64_t m_sojournMax;      //!< Largest sojourn of the interval in ns
+  uint32_t m_dequeues;        //!< Dequeues in the interval
+  std::deque<int64_t> m_arrivals; //!< Enqueue times of the queued packets
+  std::vector<uint8_t> m_buffer;  //!< Records not written yet
+};
+
+} // namespace ns3
+
+#endif /* QUEUE_SAMPLER_H */
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "redundancy-elimination-cache.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RedundancyEliminationCache");
+
+namespace {
+
+/**
+ * Gear hash table: one pseudo random 64 bit value per byte value, filled
+ * with splitmix64 so that both ends of a link cut identical chunks.
+ */
+struct GearTable
+{
+  uint64_t value[256];
+  GearTable ()
+  {
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < 256; i++)
+      {
+        x += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        value[i] = z ^ (z >> 31);
+      }
+  }
+};
+
+const GearTable g_gear;
+
+} // anonymous namespace
+
+RedundancyEliminationCache::RedundancyEliminationCache ()
+  : m_budget (65536),
+    m_storedBytes (0),
+    m_logging (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RedundancyEliminationCache::SetBudget (uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  m_budget = bytes;
+  Clear ();
+}
+
+uint32_t
+RedundancyEliminationCache::GetBudget (void) const
+{
+  return m_budget;
+}
+
+uint32_t
+RedundancyEliminationCache::GetStoredBytes (void) const
+{
+  return m_storedBytes;
+}
+
+void
+RedundancyEliminationCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_chunks.clear ();
+  m_fifo.clear ();
+  m_storedBytes = 0;
+  m_undo.clear ();
+}
+
+uint32_t
+RedundancyEliminationCache::FindChunkEnd (const std::string &data, uint32_t start)
+{
+  uint32_t size = data.size ();
+  uint32_t limit = std::min (size, start + MAX_CHUNK);
+  if (limit - start <= MIN_CHUNK)
+    {
+      return limit;
+    }
+  uint64_t hash = 0;
+  for (uint32_t i = start; i < limit; i++)
+    {
+      hash = (hash << 1) + g_gear.value[static_cast<uint8_t> (data[i])];
+      if (i + 1 - start >= MIN_CHUNK && (hash & CHUNK_MASK) == 0)
+        {
+          return i + 1;
+        }
+    }
+  return limit;
+}
+
+uint64_t
+RedundancyEliminationCache::Fingerprint (const char *data, uint32_t len)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint32_t i = 0; i < len; i++)
+    {
+      hash ^= static_cast<uint8_t> (data[i]);
+      hash *= 0x100000001b3ULL;
+    }
+  return hash;
+}
+
+void
+RedundancyEliminationCache::Insert (uint64_t fp, const std::string &chunk)
+{
+  if (chunk.size () > m_budget)
+    {
+      return;
+    }
+  std::unordered_map<uint64_t, std::string>::iterator it = m_chunks.find (fp);
+  if (it != m_chunks.end ())
+    {
+      // Fingerprint collision: the newest chunk wins on both ends.
+      if (m_logging)
+        {
+          Change change = {Change::REPLACED, fp, true, it->second};
+          m_undo.push_back (change);
+        }
+      m_storedBytes -= it->second.size ();
+      m_chunks.erase (it);
+    }
+  while (m_storedBytes + chunk.size () > m_budget && !m_fifo.empty ())
+    {
+      uint64_t oldest = m_fifo.front ();
+      it = m_chunks.find (oldest);
+      m_fifo.pop_front ();
+      if (m_logging)
+        {
+          Change change = {Change::EVICTED, oldest, it != m_chunks.end (),
+                           it != m_chunks.end () ? it->second : std::string ()};
+          m_undo.push_back (change);
+        }
+      if (it != m_chunks.end ())
+        {
+          m_storedBytes -= it->second.size ();
+          m_chunks.erase (it);
+        }
+    }
+  m_chunks[fp] = chunk;
+  m_fifo.push_back (fp);
+  m_storedBytes += chunk.size ();
+  if (m_logging)
+    {
+      Change change = {Change::INSERTED, fp, true, std::string ()};
+      m_undo.push_back (change);
+    }
+}
+
+void
+RedundancyEliminationCache::UndoEncode (void)
+{
+  NS_LOG_FUNCTION (this << m_undo.size ());
+  for (std::vector<Change>::reverse_iterator c = m_undo.rbegin (); c != m_undo.rend (); ++c)
+    {
+      switch (c->kind)
+        {
+        case Change::INSERTED:
+          m_storedBytes -= m_chunks[c->fp].size ();
+          m_chunks.erase (c->fp);
+          m_fifo.pop_back ();
+          break;
+        case Change::EVICTED:
+          m_fifo.push_front (c->fp);
+          if (c->present)
+            {
+              m_chunks[c->fp] = c->chunk;
+              m_storedBytes += c->chunk.size ();
+            }
+          break;
+        case Change::REPLACED:
+          m_chunks[c->fp] = c->chunk;
+          m_storedBytes += c->chunk.size ();
+          break;
+        }
+    }
+  m_undo.clear ();
+}
+
+void
+RedundancyEliminationCache::Encode (const std::string &data, std::string &out)
+{
+  NS_LOG_FUNCTION (this << data.size ());
+  out.clear ();
+  out.reserve (data.size () + data.size () / MIN_CHUNK * 3 + 3);
+  m_undo.clear ();
+  m_logging = true;
+
+  uint32_t start = 0;
+  while (start < data.size ())
+    {
+      uint32_t end = FindChunkEnd (data, start);
+      uint32_t len = end - start;
+      uint64_t fp = Fingerprint (data.data () + start, len);
+
+      std::unordered_map<uint64_t, std::string>::const_iterator it = m_chunks.find (fp);
+      if (it != m_chunks.end () && it->second.compare (0, std::string::npos, data, start, len) == 0)
+        {
+          out += static_cast<char> (TOKEN_REFERENCE);
+          for (int shift = 56; shift >= 0; shift -= 8)
+            {
+              out += static_cast<char> ((fp >> shift) & 0xff);
+            }
+        }
+      else
+        {
+          out += static_cast<char> (TOKEN_LITERAL);
+          out += static_cast<char> ((len >> 8) & 0xff);
+          out += static_cast<char> (len & 0xff);
+          out.append (data, start, len);
+          Insert (fp, data.substr (start, len));
+        }
+      start = end;
+    }
+  m_logging = false;
+}
+
+void
+RedundancyEliminationCache::Decode (const std::string &data, std::string &out)
+{
+  NS_LOG_FUNCTION (this << data.size ());
+  out.clear ();
+
+  uint32_t pos = 0;
+  while (pos < data.size ())
+    {
+      uint8_t tag = static_cast<uint8_t> (data[pos++]);
+      if (tag == TOKEN_LITERAL)
+        {
+          NS_ABORT_MSG_IF (pos + 2 > data.size (), "Truncated literal token");
+          uint32_t len = (static_cast<uint8_t> (data[pos]) << 8) | static_cast<uint8_t> (data[pos + 1]);
+          pos += 2;
+          NS_ABORT_MSG_IF (pos + len > data.size (), "Truncated literal chunk");
+          std::string chunk = data.substr (pos, len);
+          pos += len;
+          Insert (Fingerprint (chunk.data (), len), chunk);
+          out += chunk;
+        }
+      else if (tag == TOKEN_REFERENCE)
+        {
+          NS_ABORT_MSG_IF (pos + 8 > data.size (), "Truncated reference token");
+          uint64_t fp = 0;
+          for (int i = 0; i < 8; i++)
+            {
+              fp = (fp << 8) | static_cast<uint8_t> (data[pos++]);
+            }
+          std::unordered_map<uint64_t, std::string>::const_iterator it = m_chunks.find (fp);
+          NS_ABORT_MSG_IF (it == m_chunks.end (), "Redundancy elimination stores out of sync");
+          out += it->second;
+        }
+      else
+        {
+          NS_ABORT_MSG ("Unknown redundancy elimination token " << static_cast<uint32_t> (tag));
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REDUNDANCY_ELIMINATION_CACHE_H
+#define REDUNDANCY_ELIMINATION_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Fingerprint store used for redundancy elimination on a PPP link.
+ *
+ * Payloads are split into content-defined chunks with a gear rolling hash,
+ * so that an insertion near the front of a payload does not shift every
+ * chunk boundary behind it.  Each chunk is identified by a 64 bit
+ * fingerprint.  The encoder replaces chunks already present in the store
+ * with a reference to their fingerprint and sends every other chunk as a
+ * literal; both ends insert literals in the same order, so the encoder and
+ * decoder stores stay synchronized over a lossless, in-order link without
+ * any extra signalling.
+ *
+ * The store is bounded by a byte budget and evicts the oldest chunks first.
+ * A payload encoded but never delivered, e.g. dropped by a full transmit
+ * queue, must be taken back with UndoEncode, or the decoder store misses
+ * its literals and the next reference to them cannot be resolved.
+ *
+ * Encoded stream format, repeated until the end of the buffer:
+ *
+ *   - literal:   0x00, 16 bit length (network order), chunk bytes
+ *   - reference: 0x01, 64 bit fingerprint (network order)
+ */
+class RedundancyEliminationCache
+{
+public:
+  RedundancyEliminationCache ();
+
+  /**
+   * \brief Set the memory budget of the store
+   * \param bytes the maximum number of chunk bytes kept in the store
+   */
+  void SetBudget (uint32_t bytes);
+
+  /**
+   * \brief Get the memory budget of the store
+   * \return the maximum number of chunk bytes kept in the store
+   */
+  uint32_t GetBudget (void) const;
+
+  /**
+   * \brief Get the number of chunk bytes currently stored
+   * \return the number of chunk bytes currently stored
+   */
+  uint32_t GetStoredBytes (void) const;
+
+  /**
+   * \brief Replace the chunks of data already in the store by references
+   * \param data the payload to encode
+   * \param out receives the encoded token stream
+   */
+  void Encode (const std::string &data, std::string &out);
+
+  /**
+   * \brief Take back the last Encode
+   *
+   * Removes the chunks it inserted and restores the ones it evicted, so
+   * the store is as if the payload had never been encoded.  Only the
+   * last Encode can be undone.
+   */
+  void UndoEncode (void);
+
+  /**
+   * \brief Rebuild a payload from a token stream produced by Encode
+   * \param data the encoded token stream
+   * \param out receives the original payload
+   */
+  void Decode (const std::string &data, std::string &out);
+
+  /**
+   * \brief Drop every stored chunk
+   */
+  void Clear (void);
+
+private:
+  /**
+   * \brief Find the end of the chunk starting at the given offset
+   * \param data the payload being chunked
+   * \param start offset of the first byte of the chunk
+   * \return offset one past the last byte of the chunk
+   */
+  static uint32_t FindChunkEnd (const std::string &data, uint32_t start);
+
+  /**
+   * \brief Compute the fingerprint of a chunk (64 bit FNV-1a)
+   * \param data pointer to the first byte of the chunk
+   * \param len length of the chunk
+   * \return the chunk fingerprint
+   */
+  static uint64_t Fingerprint (const char *data, uint32_t len);
+
+  /**
+   * \brief Insert a chunk, evicting the oldest ones to stay in budget
+   * \param fp the chunk fingerprint
+   * \param chunk the chunk bytes
+   */
+  void Insert (uint64_t fp, const std::string &chunk);
+
+  /// What Insert changed, in order, for UndoEncode
+  struct Change
+  {
+    enum Kind
+    {
+      REPLACED, //!< chunk under fp overwritten after a collision
+      EVICTED,  //!< fp popped from the front of m_fifo, chunk erased if present
+      INSERTED  //!< fp pushed to the back of m_fifo, chunk stored
+    } kind;
+    uint64_t fp;       //!< Fingerprint concerned
+    bool present;      //!< EVICTED: the chunk was still in the store
+    std::string chunk; //!< REPLACED, EVICTED: the chunk removed
+  };
+
+  static const uint32_t MIN_CHUNK = 32;  //!< Smallest chunk cut by the hash
+  static const uint32_t MAX_CHUNK = 256; //!< Largest chunk, forced cut
+  static const uint64_t CHUNK_MASK = 0x3f; //!< ~64 byte average chunk
+
+  static const uint8_t TOKEN_LITERAL = 0x00;   //!< Literal chunk tag
+  static const uint8_t TOKEN_REFERENCE = 0x01; //!< Chunk reference tag
+
+  uint32_t m_budget;      //!< Maximum number of stored chunk bytes
+  uint32_t m_storedBytes; //!< Number of chunk bytes currently stored
+  std::unordered_map<uint64_t, std::string> m_chunks; //!< Fingerprint store
+  std::deque<uint64_t> m_fifo; //!< Insertion order, for eviction
+  bool m_logging;              //!< Record changes in m_undo
+  std::vector<Change> m_undo;  //!< Changes made by the last Encode
+};
+
+} // namespace ns3
+
+#endif /* REDUNDANCY_ELIMINATION_CACHE_H */
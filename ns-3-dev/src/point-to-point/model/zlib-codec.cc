@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "zlib-codec.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ZlibCodec");
+
+ZlibCodec::ZlibCodec (int level)
+  : m_deflateReady (false),
+    m_inflateReady (false),
+    m_level (level),
+    m_deflateLevel (level)
+{
+  NS_LOG_FUNCTION (this << level);
+  memset (&m_deflate, 0, sizeof (m_deflate));
+  memset (&m_inflate, 0, sizeof (m_inflate));
+}
+
+ZlibCodec::~ZlibCodec ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_deflateReady)
+    {
+      deflateEnd (&m_deflate);
+    }
+  if (m_inflateReady)
+    {
+      inflateEnd (&m_inflate);
+    }
+}
+
+void
+ZlibCodec::SetLevel (int level)
+{
+  NS_LOG_FUNCTION (this << level);
+  m_level = level;
+}
+
+void
+ZlibCodec::Compress (const std::string &prefix, const uint8_t *data, uint32_t len,
+                     std::string &out)
+{
+  NS_LOG_FUNCTION (this << prefix.size () << len);
+  if (m_deflateReady && m_deflateLevel != m_level)
+    {
+      // a new stream rather than deflateParams, whose output is only
+      // byte-identical to a fresh stream once its pending data is flushed
+      deflateEnd (&m_deflate);
+      m_deflateReady = false;
+    }
+  if (!m_deflateReady)
+    {
+      if (deflateInit (&m_deflate, m_level) != Z_OK)
+        {
+          throw (std::runtime_error ("deflateInit failed while compressing."));
+        }
+      m_deflateReady = true;
+      m_deflateLevel = m_level;
+    }
+  else if (deflateReset (&m_deflate) != Z_OK)
+    {
+      throw (std::runtime_error ("deflateReset failed while compressing."));
+    }
+
+  out.resize (deflateBound (&m_deflate, prefix.size () + len));
+
+  m_deflate.next_out = reinterpret_cast<Bytef *> (&out[0]);
+  m_deflate.avail_out = out.size ();
+  m_deflate.next_in = reinterpret_cast<Bytef *> (const_cast<char *> (prefix.data ()));
+  m_deflate.avail_in = prefix.size ();
+  if (deflate (&m_deflate, Z_NO_FLUSH) != Z_OK)
+    {
+      throw (std::runtime_error ("Exception during zlib compression of the prefix."));
+    }
+  m_deflate.next_in = const_cast<Bytef *> (data);
+  m_deflate.avail_in = len;
+
+  int ret = deflate (&m_deflate, Z_FINISH);
+  if (ret != Z_STREAM_END)
+    {
+      std::ostringstream oss;
+      oss << "Exception during zlib compression: (" << ret << ") " << m_deflate.msg;
+      throw (std::runtime_error (oss.str ()));
+    }
+  out.resize (m_deflate.total_out);
+}
+
+void
+ZlibCodec::Decompress (const uint8_t *data, uint32_t len, std::string &out)
+{
+  NS_LOG_FUNCTION (this << len);
+  if (!m_inflateReady)
+    {
+      if (inflateInit (&m_inflate) != Z_OK)
+        {
+          throw (std::runtime_error ("inflateInit failed while decompressing."));
+        }
+      m_inflateReady = true;
+    }
+  else
+    {
+      inflateReset (&m_inflate);
+    }
+
+  m_inflate.next_in = const_cast<Bytef *> (data);
+  m_inflate.avail_in = len;
+
+  uint32_t size = out.capacity () > 4 * len ? out.capacity () : 4 * len + 64;
+  int ret;
+  do
+    {
+      out.resize (size);
+      m_inflate.next_out = reinterpret_cast<Bytef *> (&out[m_inflate.total_out]);
+      m_inflate.avail_out = size - m_inflate.total_out;
+      ret = inflate (&m_inflate, Z_NO_FLUSH);
+      size *= 2;
+    }
+  while (ret == Z_OK && m_inflate.avail_out == 0);
+
+  if (ret != Z_STREAM_END)
+    {
+      std::ostringstream oss;
+      oss << "Exception during zlib decompression: (" << ret << ") "
+          << m_inflate.msg;
+      throw (std::runtime_error (oss.str ()));
+    }
+  out.resize (m_inflate.total_out);
+}
+
+} // namespace ns3
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ZLIB_CODEC_H
+#define ZLIB_CODEC_H
+
+#include <stdint.h>
+#include <string>
+#include <zlib.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Reusable zlib streams for the per-packet compression path.
+ *
+ * zlib_compress_string and zlib_decompress_string set up and tear down a
+ * complete z_stream (several hundred kilobytes at Z_BEST_COMPRESSION) for
+ * every call.  This class keeps one deflate and one inflate stream alive
+ * and resets them between packets, and writes into caller owned strings
+ * whose capacity is kept from one packet to the next, so once warmed up
+ * the codec itself does not allocate.  The output is byte-identical to
+ * the string helpers.
+ *
+ * Changing the level sets up a new deflate stream on the next packet.
+ */
+class ZlibCodec
+{
+public:
+  /**
+   * \param level the deflate compression level
+   */
+  ZlibCodec (int level = Z_BEST_COMPRESSION);
+  ~ZlibCodec ();
+
+  /**
+   * \brief Set the deflate compression level
+   * \param level the new level
+   */
+  void SetLevel (int level);
+
+  /**
+   * \brief Deflate prefix followed by data
+   * \param prefix bytes compressed in front of the data
+   * \param data pointer to the data
+   * \param len length of the data
+   * \param out receives the compressed stream
+   */
+  void Compress (const std::string &prefix, const uint8_t *data, uint32_t len,
+                 std::string &out);
+
+  /**
+   * \brief Inflate a complete zlib stream
+   * \param data pointer to the compressed stream
+   * \param len length of the compressed stream
+   * \param out receives the decompressed bytes
+   */
+  void Decompress (const uint8_t *data, uint32_t len, std::string &out);
+
+private:
+  ZlibCodec (const ZlibCodec &);
+  ZlibCodec & operator = (const ZlibCodec &);
+
+  z_stream m_deflate;  //!< Deflate stream, reset between packets
+  z_stream m_inflate;  //!< Inflate stream, reset between packets
+  bool m_deflateReady; //!< m_deflate has been initialized
+  bool m_inflateReady; //!< m_inflate has been initialized
+  int m_level;         //!< Deflate compression level
+  int m_deflateLevel;  //!< Level m_deflate was initialized with
+};
+
+} // namespace ns3
+
+#endif /* ZLIB_CODEC_H */
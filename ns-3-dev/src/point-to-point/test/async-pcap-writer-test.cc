@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/async-pcap-writer.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Records written through several buffers read back in order
+ */
+class AsyncPcapWriterTestCase : public TestCase
+{
+public:
+  /**
+   * \param gzip write the file through gzip
+   */
+  AsyncPcapWriterTestCase (bool gzip);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param data the file contents
+   * \param offset byte offset of the field, advanced past it
+   * \return the field
+   */
+  uint32_t Read32 (const std::string &data, uint32_t &offset);
+
+  bool m_gzip; //!< Write the file through gzip
+};
+
+AsyncPcapWriterTestCase::AsyncPcapWriterTestCase (bool gzip)
+  : TestCase (gzip ? "AsyncPcapWriter records, gzip" : "AsyncPcapWriter records"),
+    m_gzip (gzip)
+{
+}
+
+uint32_t
+AsyncPcapWriterTestCase::Read32 (const std::string &data, uint32_t &offset)
+{
+  uint32_t value;
+  std::memcpy (&value, data.data () + offset, 4);
+  offset += 4;
+  return value;
+}
+
+void
+AsyncPcapWriterTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename (m_gzip ? "async-pcap.pcap.gz" : "async-pcap.pcap");
+  const uint32_t snapLen = 100;
+  const uint32_t packets = 500;
+  uint32_t allocated;
+  {
+    // 4096 byte buffers, so the records span many of them, at most 2 queued
+    Ptr<AsyncPcapWriter> writer = Create<AsyncPcapWriter> (filename, 9, snapLen, m_gzip, 4096, 2);
+    for (uint32_t i = 0; i < packets; i++)
+      {
+        std::vector<uint8_t> bytes (i % 150 + 1);
+        for (uint32_t j = 0; j < bytes.size (); j++)
+          {
+            bytes[j] = i + j;
+          }
+        writer->Write (MicroSeconds (1999990 + i * 7), Create<Packet> (bytes.data (), bytes.size ()));
+      }
+    NS_TEST_EXPECT_MSG_EQ (writer->Close (), true, "write failed");
+    allocated = writer->GetBuffersAllocated ();
+  }
+  NS_TEST_EXPECT_MSG_GT (allocated, 0, "at least the initial buffer");
+  // the one being filled, the queued ones and the one being written
+  NS_TEST_EXPECT_MSG_LT (allocated, 5, "backlog exceeded its bound");
+
+  // gzread also reads a file that is not compressed
+  std::string data;
+  gzFile in = gzopen (filename.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (in, 0, "cannot open " << filename);
+  char chunk[4096];
+  int n;
+  while ((n = gzread (in, chunk, sizeof (chunk))) > 0)
+    {
+      data.append (chunk, n);
+    }
+  gzclose (in);
+
+  uint32_t offset = 0;
+  NS_TEST_ASSERT_MSG_EQ (data.size () > 24, true, "no global header");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (data, offset), 0xa1b2c3d4, "magic");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (data, offset), 0x00040002, "version 2.4");
+  offset += 8;
+  NS_TEST_EXPECT_MSG_EQ (Read32 (data, offset), snapLen, "snap length");
+  NS_TEST_EXPECT_MSG_EQ (Read32 (data, offset), 9, "data link type");
+
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (offset + 16 <= data.size (), true, "record " << i << " missing");
+      uint64_t us = 1999990 + i * 7;
+      uint32_t origLen = i % 150 + 1;
+      uint32_t inclLen = std::min (origLen, snapLen);
+      NS_TEST_ASSERT_MSG_EQ (Read32 (data, offset), us / 1000000, "seconds of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (Read32 (data, offset), us % 1000000, "microseconds of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (Read32 (data, offset), inclLen, "included length of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (Read32 (data, offset), origLen, "original length of record " << i);
+      NS_TEST_ASSERT_MSG_EQ (offset + inclLen <= data.size (), true, "record " << i << " truncated");
+      for (uint32_t j = 0; j < inclLen; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (uint32_t (uint8_t (data[offset + j])), uint32_t (uint8_t (i + j)),
+                                 "byte " << j << " of record " << i);
+        }
+      offset += inclLen;
+    }
+  NS_TEST_EXPECT_MSG_EQ (offset, data.size (), "trailing bytes");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief A write the device refuses is reported by Close
+ *
+ * Writes to /dev/full, where every write fails with ENOSPC, and is
+ * skipped where it does not exist.
+ */
+class AsyncPcapWriterFailureTestCase : public TestCase
+{
+public:
+  /**
+   * \param gzip write the file through gzip
+   */
+  AsyncPcapWriterFailureTestCase (bool gzip);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_gzip; //!< Write the file through gzip
+};
+
+AsyncPcapWriterFailureTestCase::AsyncPcapWriterFailureTestCase (bool gzip)
+  : TestCase (gzip ? "AsyncPcapWriter write failure, gzip" : "AsyncPcapWriter write failure"),
+    m_gzip (gzip)
+{
+}
+
+void
+AsyncPcapWriterFailureTestCase::DoRun (void)
+{
+  std::FILE *full = std::fopen ("/dev/full", "wb");
+  if (full == 0)
+    {
+      return;
+    }
+  std::fclose (full);
+
+  Ptr<AsyncPcapWriter> writer = Create<AsyncPcapWriter> ("/dev/full", 9, 100, m_gzip, 4096, 2);
+  std::vector<uint8_t> bytes (100, 0x5a);
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      writer->Write (MicroSeconds (i), Create<Packet> (bytes.data (), bytes.size ()));
+    }
+  NS_TEST_EXPECT_MSG_EQ (writer->Close (), false, "failure not reported");
+  NS_TEST_EXPECT_MSG_EQ (writer->Close (), false, "failure not kept");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief AsyncPcapWriter test suite
+ */
+class AsyncPcapWriterTestSuite : public TestSuite
+{
+public:
+  AsyncPcapWriterTestSuite ();
+};
+
+AsyncPcapWriterTestSuite::AsyncPcapWriterTestSuite ()
+  : TestSuite ("async-pcap-writer", UNIT)
+{
+  AddTestCase (new AsyncPcapWriterTestCase (false), TestCase::QUICK);
+  AddTestCase (new AsyncPcapWriterTestCase (true), TestCase::QUICK);
+  AddTestCase (new AsyncPcapWriterFailureTestCase (false), TestCase::QUICK);
+  AddTestCase (new AsyncPcapWriterFailureTestCase (true), TestCase::QUICK);
+}
+
+static AsyncPcapWriterTestSuite g_asyncPcapWriterTestSuite; //!< The test suite
@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/test.h"
+#include "ns3/compression-controller.h"
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t FRAME = 1500; //!< Frame size of every test frame
+
+// Level with the smallest modeled cost, from the public estimates
+int
+Cheapest (const CompressionController &c, double linkBps, bool backlogged)
+{
+  int best = 0;
+  double bestCost = 0;
+  for (int level = 0; level <= CompressionController::MAX_LEVEL; level++)
+    {
+      double codec = c.GetCodecTime (level, FRAME);
+      double wire = FRAME * c.GetRatio (level) * 8.0 / linkBps;
+      double cost = backlogged ? std::max (codec, wire) : codec + wire;
+      if (level == 0 || cost < bestCost)
+        {
+          best = level;
+          bestCost = cost;
+        }
+    }
+  return best;
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup point-to-point-test
+ * \brief A fixed level is returned as is
+ */
+class CompressionControllerFixedTestCase : public TestCase
+{
+public:
+  CompressionControllerFixedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionControllerFixedTestCase::CompressionControllerFixedTestCase ()
+  : TestCase ("CompressionController fixed level")
+{
+}
+
+void
+CompressionControllerFixedTestCase::DoRun (void)
+{
+  CompressionController c;
+  c.SetLevel (6);
+  c.NotifyCompressed (6, 1000, 1000);
+  for (int i = 0; i < 200; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (c.Decide (MicroSeconds (i * 100), FRAME, 0, 1e6), 6, "frame " << i);
+    }
+
+  // adaptive without an observation keeps the configured level
+  CompressionController a;
+  a.SetAdaptive (true);
+  a.SetInterval (Time (0));
+  NS_TEST_ASSERT_MSG_EQ (a.Decide (Time (0), FRAME, 0, 1e9), 9, "no ratio observed yet");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Incompressible traffic turns compression off, with probes
+ */
+class CompressionControllerOffTestCase : public TestCase
+{
+public:
+  CompressionControllerOffTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionControllerOffTestCase::CompressionControllerOffTestCase ()
+  : TestCase ("CompressionController incompressible traffic")
+{
+}
+
+void
+CompressionControllerOffTestCase::DoRun (void)
+{
+  CompressionController c;
+  c.SetAdaptive (true);
+  c.SetInterval (Time (0));
+  c.SetProbeInterval (16);
+  c.NotifyCompressed (9, 1000, 1010);
+  NS_TEST_ASSERT_MSG_EQ (c.Decide (Time (0), FRAME, 0, 1e6), 0, "incompressible on a slow link");
+  NS_TEST_ASSERT_MSG_EQ (c.GetLevel (), 0, "adopted");
+
+  uint32_t probes = 0;
+  for (int i = 1; i <= 64; i++)
+    {
+      int level = c.Decide (MicroSeconds (i), FRAME, 0, 1e6);
+      if (level != 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (level, 1, "probes deflate at level 1");
+          NS_TEST_ASSERT_MSG_EQ (i % 16, 15, "one probe every 16 frames");
+          probes++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (probes, 4, "probes");
+  NS_TEST_ASSERT_MSG_EQ (c.GetLevel (), 0, "probes do not change the level");
+
+  // a compressible probe brings compression back
+  for (int i = 0; i < 30; i++)
+    {
+      c.NotifyCompressed (1, 1000, 100);
+    }
+  NS_TEST_ASSERT_MSG_GT (c.Decide (MilliSeconds (1), FRAME, 0, 1e6), 0, "compressible again");
+
+  c.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (c.GetLevel (), 9, "Reset restores the configured level");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief The level follows the link rate and backlog
+ */
+class CompressionControllerLinkTestCase : public TestCase
+{
+public:
+  CompressionControllerLinkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionControllerLinkTestCase::CompressionControllerLinkTestCase ()
+  : TestCase ("CompressionController link state")
+{
+}
+
+void
+CompressionControllerLinkTestCase::DoRun (void)
+{
+  CompressionController c;
+  c.SetAdaptive (true);
+  c.SetInterval (Time (0));
+  c.NotifyCompressed (9, 1000, 100);
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (9), 0.1, 1e-12, "observed ratio");
+  NS_TEST_ASSERT_MSG_GT (c.GetRatio (1), c.GetRatio (9), "lower levels compress less");
+  NS_TEST_ASSERT_MSG_GT (c.GetCodecTime (9, FRAME), c.GetCodecTime (1, FRAME), "higher levels are slower");
+
+  // the codec costs more than the wire saves on a fast idle link
+  NS_TEST_ASSERT_MSG_EQ (c.Decide (Time (0), FRAME, 0, 10e9), 0, "10 Gb/s idle");
+
+  // a slow idle link pays codec and wire in turn: the fastest level wins
+  int idle = c.Decide (Time (0), FRAME, 0, 10e6);
+  NS_TEST_ASSERT_MSG_EQ (idle, Cheapest (c, 10e6, false), "10 Mb/s idle");
+  NS_TEST_ASSERT_MSG_EQ (idle, 1, "10 Mb/s idle");
+
+  // backlogged, codec and wire overlap: a slower level fits under the wire time
+  int busy = c.Decide (Time (0), FRAME, 3000, 10e6);
+  NS_TEST_ASSERT_MSG_EQ (busy, Cheapest (c, 10e6, true), "10 Mb/s backlogged");
+  NS_TEST_ASSERT_MSG_GT (busy, idle, "backlog raises the level");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief At most one change per control interval
+ */
+class CompressionControllerIntervalTestCase : public TestCase
+{
+public:
+  CompressionControllerIntervalTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionControllerIntervalTestCase::CompressionControllerIntervalTestCase ()
+  : TestCase ("CompressionController control interval")
+{
+}
+
+void
+CompressionControllerIntervalTestCase::DoRun (void)
+{
+  CompressionController c;
+  c.SetAdaptive (true);
+  c.SetInterval (MilliSeconds (10));
+  c.NotifyCompressed (9, 1000, 100);
+
+  int idle = c.Decide (MilliSeconds (1), FRAME, 0, 10e6);
+  NS_TEST_ASSERT_MSG_EQ (idle, 1, "first decision of the interval");
+  // the queue builds up within the same interval, the level holds
+  NS_TEST_ASSERT_MSG_EQ (c.Decide (MilliSeconds (2), FRAME, 3000, 10e6), idle, "second decision in the interval");
+  NS_TEST_ASSERT_MSG_EQ (c.Decide (MilliSeconds (9), FRAME, 3000, 10e6), idle, "last decision in the interval");
+  // next interval
+  NS_TEST_ASSERT_MSG_GT (c.Decide (MilliSeconds (11), FRAME, 3000, 10e6), idle, "next interval");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Each level keeps its own ratio, unobserved levels borrow one
+ */
+class CompressionControllerRatioTestCase : public TestCase
+{
+public:
+  CompressionControllerRatioTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CompressionControllerRatioTestCase::CompressionControllerRatioTestCase ()
+  : TestCase ("CompressionController per-level ratios")
+{
+}
+
+void
+CompressionControllerRatioTestCase::DoRun (void)
+{
+  CompressionController c;
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (9), 1, 1e-12, "nothing observed");
+
+  c.NotifyCompressed (9, 1000, 100);
+  c.NotifyCompressed (3, 1000, 500);
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (9), 0.1, 1e-12, "level 9 observed");
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (3), 0.5, 1e-12, "level 3 observed, not scaled from level 9");
+  // nearest observed level, scaled by the level gain
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (4), 0.5 * 1.10 / 1.12, 1e-12, "level 4 from level 3");
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (7), 0.1 * 1.04, 1e-12, "level 7 from level 9");
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (6), 0.1 * 1.06, 1e-12, "tie goes to the higher level");
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (0), 1, 1e-12, "level 0 sends as is");
+
+  // the running average moves an eighth of the way per frame
+  c.NotifyCompressed (3, 1000, 900);
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (3), 0.55, 1e-12, "level 3 average");
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (9), 0.1, 1e-12, "level 9 untouched");
+
+  c.SetLevelGain (0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (8), 0.1, 1e-12, "no gain assumed");
+
+  c.Reset ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (c.GetRatio (3), 1, 1e-12, "Reset forgets the ratios");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief CompressionController test suite
+ */
+class CompressionControllerTestSuite : public TestSuite
+{
+public:
+  CompressionControllerTestSuite ();
+};
+
+CompressionControllerTestSuite::CompressionControllerTestSuite ()
+  : TestSuite ("compression-controller", UNIT)
+{
+  AddTestCase (new CompressionControllerFixedTestCase (), TestCase::QUICK);
+  AddTestCase (new CompressionControllerOffTestCase (), TestCase::QUICK);
+  AddTestCase (new CompressionControllerLinkTestCase (), TestCase::QUICK);
+  AddTestCase (new CompressionControllerIntervalTestCase (), TestCase::QUICK);
+  AddTestCase (new CompressionControllerRatioTestCase (), TestCase::QUICK);
+}
+
+static CompressionControllerTestSuite g_compressionControllerTestSuite; //!< The test suite
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/data-rate.h"
+#include "ns3/mac48-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t BURSTS = 20;      //!< Bursts sent, one every 5 ms
+const uint32_t BURST = 8;        //!< Datagrams per burst, sent in one event
+const uint32_t PAYLOAD = 1000;   //!< Payload size, half of it incompressible
+
+} // anonymous namespace
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Compressing on worker threads changes nothing the simulation sees
+ *
+ * The same bursts cross a compressing link with CompressionThreads 0 and
+ * 2.  The queue holds 3000 bytes, so which frames it drops depends on
+ * their compressed size.  Every MacTx, MacTxDrop and queue event of the
+ * sender, and every MacRx event of the receiver, with its time and bytes,
+ * must be the same in both runs.  The two ends are compared apart: events
+ * of both at the same instant may run in either order.
+ */
+class CompressionPoolTestCase : public TestCase
+{
+public:
+  /**
+   * \param adaptive whether the controller chooses the level
+   */
+  CompressionPoolTestCase (bool adaptive);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the bursts through a fresh link
+   * \param threads CompressionThreads of the compressing end
+   * \return the events of the sender followed by those of the receiver
+   */
+  std::vector<std::string> RunLink (uint32_t threads);
+
+  /**
+   * \brief Send one burst of datagrams
+   * \param burst the burst index
+   */
+  void SendBurst (uint32_t burst);
+
+  /**
+   * \brief Append an event to a log
+   * \param log the log
+   * \param kind the trace that fired
+   * \param p the packet
+   */
+  void Record (std::vector<std::string> &log, std::string kind, Ptr<const Packet> p);
+
+  void MacTx (Ptr<const Packet> p);     //!< \param p the packet
+  void MacTxDrop (Ptr<const Packet> p); //!< \param p the packet
+  void Enqueue (Ptr<const Packet> p);   //!< \param p the packet
+  void Dequeue (Ptr<const Packet> p);   //!< \param p the packet
+  void QueueDrop (Ptr<const Packet> p); //!< \param p the packet
+  void MacRx (Ptr<const Packet> p);     //!< \param p the packet
+
+  /**
+   * \brief Receive callback of the decompressing end
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address &);
+
+  bool m_adaptive;                    //!< The controller chooses the level
+  Ptr<PointToPointNetDevice> m_tx;    //!< Compressing end
+  Ptr<PointToPointNetDevice> m_rx;    //!< Decompressing end
+  std::vector<std::string> m_txLog;   //!< Sender events of the current run
+  std::vector<std::string> m_rxLog;   //!< Receiver events of the current run
+};
+
+CompressionPoolTestCase::CompressionPoolTestCase (bool adaptive)
+  : TestCase (adaptive ? "CompressionThreads with an adaptive level" : "CompressionThreads with a fixed level"),
+    m_adaptive (adaptive)
+{
+}
+
+void
+CompressionPoolTestCase::Record (std::vector<std::string> &log, std::string kind, Ptr<const Packet> p)
+{
+  std::string bytes (p->GetSize (), '\0');
+  if (!bytes.empty ())
+    {
+      p->CopyData (reinterpret_cast<uint8_t *> (&bytes[0]), bytes.size ());
+    }
+  std::ostringstream oss;
+  oss << Simulator::Now ().GetTimeStep () << " " << kind << " " << p->GetSize () << " " << bytes;
+  log.push_back (oss.str ());
+}
+
+void
+CompressionPoolTestCase::MacTx (Ptr<const Packet> p)
+{
+  Record (m_txLog, "MacTx", p);
+}
+
+void
+CompressionPoolTestCase::MacTxDrop (Ptr<const Packet> p)
+{
+  Record (m_txLog, "MacTxDrop", p);
+}
+
+void
+CompressionPoolTestCase::Enqueue (Ptr<const Packet> p)
+{
+  Record (m_txLog, "Enqueue", p);
+}
+
+void
+CompressionPoolTestCase::Dequeue (Ptr<const Packet> p)
+{
+  Record (m_txLog, "Dequeue", p);
+}
+
+void
+CompressionPoolTestCase::QueueDrop (Ptr<const Packet> p)
+{
+  Record (m_txLog, "QueueDrop", p);
+}
+
+void
+CompressionPoolTestCase::MacRx (Ptr<const Packet> p)
+{
+  Record (m_rxLog, "MacRx", p);
+}
+
+bool
+CompressionPoolTestCase::Receive (Ptr<NetDevice>, Ptr<const Packet>, uint16_t, const Address &)
+{
+  return true;
+}
+
+void
+CompressionPoolTestCase::SendBurst (uint32_t burst)
+{
+  uint32_t state = burst + 1;
+  for (uint32_t i = 0; i < BURST; i++)
+    {
+      // the first half is noise from a fixed generator, the second half zeros
+      std::vector<uint8_t> payload (PAYLOAD, 0);
+      for (uint32_t j = 0; j < PAYLOAD / 2; j++)
+        {
+          state = state * 1103515245 + 12345;
+          payload[j] = state >> 24;
+        }
+      Ptr<Packet> p = Create<Packet> (&payload[0], PAYLOAD);
+      SeqTsHeader seqTs;
+      seqTs.SetSeq (burst * BURST + i);
+      p->AddHeader (seqTs);
+      UdpHeader udp;
+      udp.SetSourcePort (49153);
+      udp.SetDestinationPort (9);
+      p->AddHeader (udp);
+      Ipv4Header ipv4;
+      ipv4.SetSource (Ipv4Address ("10.1.1.1"));
+      ipv4.SetDestination (Ipv4Address ("10.1.1.2"));
+      ipv4.SetProtocol (17);
+      ipv4.SetTtl (64);
+      ipv4.SetPayloadSize (p->GetSize ());
+      p->AddHeader (ipv4);
+      m_tx->Send (p, m_rx->GetAddress (), 0x0800);
+    }
+}
+
+std::vector<std::string>
+CompressionPoolTestCase::RunLink (uint32_t threads)
+{
+  m_txLog.clear ();
+  m_rxLog.clear ();
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  m_tx = CreateObject<PointToPointNetDevice> ();
+  m_rx = CreateObject<PointToPointNetDevice> ();
+  m_tx->SetAddress (Mac48Address::Allocate ());
+  m_rx->SetAddress (Mac48Address::Allocate ());
+  m_tx->SetDataRate (DataRate ("10Mbps"));
+  m_rx->SetDataRate (DataRate ("10Mbps"));
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetAttribute ("MaxSize", StringValue ("3000B"));
+  m_tx->SetQueue (queue);
+  m_rx->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  a->AddDevice (m_tx);
+  b->AddDevice (m_rx);
+  m_tx->Attach (channel);
+  m_rx->Attach (channel);
+
+  m_tx->SetAttribute ("CompressionThreads", UintegerValue (threads));
+  m_tx->SetAttribute ("CompressionLevel", UintegerValue (6));
+  m_tx->SetAttribute ("AdaptiveCompression", BooleanValue (m_adaptive));
+  m_tx->EnableCompression ();
+  m_rx->EnableDecompression ();
+  m_rx->SetReceiveCallback (MakeCallback (&CompressionPoolTestCase::Receive, this));
+
+  m_tx->TraceConnectWithoutContext ("MacTx", MakeCallback (&CompressionPoolTestCase::MacTx, this));
+  m_tx->TraceConnectWithoutContext ("MacTxDrop", MakeCallback (&CompressionPoolTestCase::MacTxDrop, this));
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&CompressionPoolTestCase::Enqueue, this));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&CompressionPoolTestCase::Dequeue, this));
+  queue->TraceConnectWithoutContext ("Drop", MakeCallback (&CompressionPoolTestCase::QueueDrop, this));
+  m_rx->TraceConnectWithoutContext ("MacRx", MakeCallback (&CompressionPoolTestCase::MacRx, this));
+
+  for (uint32_t i = 0; i < BURSTS; i++)
+    {
+      Simulator::Schedule (MilliSeconds (5 * i), &CompressionPoolTestCase::SendBurst, this, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_tx = 0;
+  m_rx = 0;
+  std::vector<std::string> log = m_txLog;
+  log.insert (log.end (), m_rxLog.begin (), m_rxLog.end ());
+  return log;
+}
+
+void
+CompressionPoolTestCase::DoRun (void)
+{
+  std::vector<std::string> inline_ = RunLink (0);
+  std::vector<std::string> pooled = RunLink (2);
+
+  uint32_t drops = 0;
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < inline_.size (); i++)
+    {
+      drops += inline_[i].find (" QueueDrop ") != std::string::npos;
+      received += inline_[i].find (" MacRx ") != std::string::npos;
+    }
+  NS_TEST_ASSERT_MSG_GT (drops, 0, "the queue never filled up, sizes were not exercised");
+  NS_TEST_ASSERT_MSG_GT (received, 0, "nothing crossed the link");
+
+  NS_TEST_ASSERT_MSG_EQ (pooled.size (), inline_.size (), "number of events");
+  for (uint32_t i = 0; i < inline_.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((pooled[i] == inline_[i]), true, "event " << i << " differs");
+    }
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Compression worker pool test suite
+ */
+class CompressionPoolTestSuite : public TestSuite
+{
+public:
+  CompressionPoolTestSuite ();
+};
+
+CompressionPoolTestSuite::CompressionPoolTestSuite ()
+  : TestSuite ("compression-pool", UNIT)
+{
+  AddTestCase (new CompressionPoolTestCase (false), TestCase::QUICK);
+  AddTestCase (new CompressionPoolTestCase (true), TestCase::QUICK);
+}
+
+static CompressionPoolTestSuite g_compressionPoolTestSuite; //!< The test suite
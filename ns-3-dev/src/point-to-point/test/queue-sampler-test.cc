@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/queue-sampler.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Records of a QueueSampler file match the documented layout
+ */
+class QueueSamplerFormatTestCase : public TestCase
+{
+public:
+  QueueSamplerFormatTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param data the file contents
+   * \param offset byte offset of the field, advanced past it
+   * \return the field
+   */
+  template <typename T>
+  T Read (const std::string &data, uint32_t &offset);
+};
+
+QueueSamplerFormatTestCase::QueueSamplerFormatTestCase ()
+  : TestCase ("QueueSampler file format")
+{
+}
+
+template <typename T>
+T
+QueueSamplerFormatTestCase::Read (const std::string &data, uint32_t &offset)
+{
+  T value;
+  std::memcpy (&value, data.data () + offset, sizeof (T));
+  offset += sizeof (T);
+  return value;
+}
+
+void
+QueueSamplerFormatTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("queue-sampler.bin");
+  {
+    QueueSampler sampler (filename, MilliSeconds (1));
+    // interval 0: two arrivals and a departure after 800 us
+    sampler.NotifyEnqueue (MicroSeconds (100), 1, 100);
+    sampler.NotifyEnqueue (MicroSeconds (500), 2, 300);
+    sampler.NotifyDequeue (MicroSeconds (900), 1, 200);
+    // intervals 1 and 2 are quiet, interval 3 drains the queue
+    sampler.NotifyDequeue (MicroSeconds (3200), 0, 0);
+    // interval 5: one packet queued when the sampler is destroyed
+    sampler.NotifyEnqueue (MicroSeconds (5000), 1, 50);
+  }
+
+  std::ifstream ifs (filename.c_str (), std::ios::binary);
+  std::string data ((std::istreambuf_iterator<char> (ifs)), std::istreambuf_iterator<char> ());
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 16 + 3 * 24, "header and three records");
+
+  uint32_t offset = 4;
+  NS_TEST_ASSERT_MSG_EQ (data.substr (0, 4), "QSMP", "magic");
+  NS_TEST_ASSERT_MSG_EQ (Read<uint32_t> (data, offset), 1, "version");
+  NS_TEST_ASSERT_MSG_EQ (Read<int64_t> (data, offset), 1000000, "resolution in ns");
+
+  const int64_t start[] = {0, 3000000, 5000000};
+  const uint32_t packets[] = {1, 0, 1};
+  const uint32_t bytes[] = {200, 0, 50};
+  const uint32_t meanSojourn[] = {800, 2700, 0};
+  const uint32_t maxSojourn[] = {800, 2700, 0};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Read<int64_t> (data, offset), start[i], "interval start of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (Read<uint32_t> (data, offset), packets[i], "packets of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (Read<uint32_t> (data, offset), bytes[i], "bytes of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (Read<uint32_t> (data, offset), meanSojourn[i], "mean sojourn of record " << i);
+      NS_TEST_EXPECT_MSG_EQ (Read<uint32_t> (data, offset), maxSojourn[i], "max sojourn of record " << i);
+    }
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief QueueSampler test suite
+ */
+class QueueSamplerTestSuite : public TestSuite
+{
+public:
+  QueueSamplerTestSuite ();
+};
+
+QueueSamplerTestSuite::QueueSamplerTestSuite ()
+  : TestSuite ("queue-sampler", UNIT)
+{
+  AddTestCase (new QueueSamplerFormatTestCase (), TestCase::QUICK);
+}
+
+static QueueSamplerTestSuite g_queueSamplerTestSuite; //!< The test suite
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+#include "ns3/test.h"
+#include "ns3/redundancy-elimination-cache.h"
+
+using namespace ns3;
+
+namespace {
+
+// Deterministic bytes that do not repeat within a payload
+std::string
+MakePayload (uint32_t size, uint32_t seed)
+{
+  std::string payload (size, '\0');
+  uint32_t x = seed * 2654435761u + 1;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      x = x * 1664525 + 1013904223;
+      payload[i] = static_cast<char> (x >> 24);
+    }
+  return payload;
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Payloads survive an encoder/decoder pair and repeats shrink
+ */
+class RedundancyEliminationRoundTripTestCase : public TestCase
+{
+public:
+  RedundancyEliminationRoundTripTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RedundancyEliminationRoundTripTestCase::RedundancyEliminationRoundTripTestCase ()
+  : TestCase ("Redundancy elimination round trip")
+{
+}
+
+void
+RedundancyEliminationRoundTripTestCase::DoRun (void)
+{
+  RedundancyEliminationCache encoder;
+  RedundancyEliminationCache decoder;
+  std::string encoded;
+  std::string decoded;
+
+  std::string first = MakePayload (1100, 1);
+  encoder.Encode (first, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ ((decoded == first), true, "first payload not rebuilt");
+  NS_TEST_ASSERT_MSG_GT (encoded.size (), first.size (), "a new payload goes out as literals");
+
+  encoder.Encode (first, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ ((decoded == first), true, "repeated payload not rebuilt");
+  NS_TEST_ASSERT_MSG_LT (encoded.size (), first.size () / 4, "a repeated payload goes out as references");
+
+  // a shifted copy keeps most chunk boundaries
+  std::string shifted = "xyz" + first;
+  encoder.Encode (shifted, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ ((decoded == shifted), true, "shifted payload not rebuilt");
+  NS_TEST_ASSERT_MSG_LT (encoded.size (), shifted.size () / 2, "content defined chunks survive a shift");
+
+  std::string empty;
+  encoder.Encode (empty, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ (decoded.size (), 0, "empty payload");
+  NS_TEST_ASSERT_MSG_EQ (encoder.GetStoredBytes (), decoder.GetStoredBytes (), "stores diverged");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief A dropped, undone frame leaves the stores in step
+ *
+ * The encoder stores the literals of a frame that is then dropped before
+ * reaching the decoder.  Without UndoEncode the next frame refers to
+ * them and the decoder aborts; with it the next frame is sent as
+ * literals again.  A small budget makes the dropped frame evict chunks
+ * that must come back.
+ */
+class RedundancyEliminationDropTestCase : public TestCase
+{
+public:
+  RedundancyEliminationDropTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RedundancyEliminationDropTestCase::RedundancyEliminationDropTestCase ()
+  : TestCase ("Redundancy elimination with a dropped frame")
+{
+}
+
+void
+RedundancyEliminationDropTestCase::DoRun (void)
+{
+  RedundancyEliminationCache encoder;
+  RedundancyEliminationCache decoder;
+  encoder.SetBudget (2048);
+  decoder.SetBudget (2048);
+  std::string encoded;
+  std::string decoded;
+
+  std::string kept = MakePayload (1500, 1);
+  encoder.Encode (kept, encoded);
+  decoder.Decode (encoded, decoded);
+  uint32_t stored = encoder.GetStoredBytes ();
+
+  // dropped: fills the budget and evicts part of kept on the encoder only
+  std::string dropped = MakePayload (1500, 2);
+  encoder.Encode (dropped, encoded);
+  encoder.UndoEncode ();
+  NS_TEST_ASSERT_MSG_EQ (encoder.GetStoredBytes (), stored, "undo did not restore the store size");
+
+  // both payloads again: references to kept, literals for dropped
+  encoder.Encode (kept, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ ((decoded == kept), true, "evicted chunks were not restored");
+  NS_TEST_ASSERT_MSG_LT (encoded.size (), kept.size () / 4, "kept payload should be referenced");
+
+  encoder.Encode (dropped, encoded);
+  decoder.Decode (encoded, decoded);
+  NS_TEST_ASSERT_MSG_EQ ((decoded == dropped), true, "dropped payload not rebuilt");
+  NS_TEST_ASSERT_MSG_GT (encoded.size (), dropped.size (), "dropped payload must go out as literals");
+  NS_TEST_ASSERT_MSG_EQ (encoder.GetStoredBytes (), decoder.GetStoredBytes (), "stores diverged");
+
+  // a long run of frames with every third one dropped
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      std::string payload = MakePayload (1000, i % 7);
+      encoder.Encode (payload, encoded);
+      if (i % 3 == 2)
+        {
+          encoder.UndoEncode ();
+          continue;
+        }
+      decoder.Decode (encoded, decoded);
+      NS_TEST_ASSERT_MSG_EQ ((decoded == payload), true, "frame " << i << " not rebuilt");
+    }
+  NS_TEST_ASSERT_MSG_EQ (encoder.GetStoredBytes (), decoder.GetStoredBytes (), "stores diverged");
+}
+
+/**
+ * \ingroup point-to-point-test
+ * \brief Redundancy elimination fingerprint store test suite
+ */
+class RedundancyEliminationTestSuite : public TestSuite
+{
+public:
+  RedundancyEliminationTestSuite ();
+};
+
+RedundancyEliminationTestSuite::RedundancyEliminationTestSuite ()
+  : TestSuite ("redundancy-elimination", UNIT)
+{
+  AddTestCase (new RedundancyEliminationRoundTripTestCase (), TestCase::QUICK);
+  AddTestCase (new RedundancyEliminationDropTestCase (), TestCase::QUICK);
+}
+
+static RedundancyEliminationTestSuite g_redundancyEliminationTestSuite; //!< The test suite
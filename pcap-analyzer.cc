@@ -0,0 +1,298 @@
+//$ g++ -O2 -std=c++11 pcap-analyzer.cc -lz -o pcap-analyzer
+//$ ./pcap-analyzer --threshold=100 p1_*.pcap*
+
+// Recomputes the sweep results from the pcaps cs621IdliP1 writes, without
+// simulating again.  Files are grouped by run (everything before the
+// trailing -<node>-<device>.pcap).  Every topology has 4 nodes, so node
+// id % 4 == 3 is the server, received on device 1, and node id % 4 == 1
+// sends on the ndc12 bottleneck from device 2 (device 0 is the loopback).
+// Plain and gzip files are both read through zlib in large sequential reads.
+//
+// A device capture holds the frames it sends as well as those it receives.
+// Addresses are assigned client first, so a frame travels towards the
+// server when its IPv4 destination is above its source.  The measured
+// flow is the server bound flow with the lowest UDP port, which the driver
+// gives to flow 0.  Its arrivals are checked for gaps in their sequence
+// numbers: a capture thinned with --pcapSample cannot give the arrival
+// spread, and is refused.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+struct Frame {
+    bool ipv4;                      // PPP frame carrying an IPv4 header, even if the payload is compressed
+    uint32_t src;                   // IPv4 source address
+    uint32_t dst;                   // IPv4 destination address
+    bool udp;                       // UDP with its ports and sequence number captured
+    uint16_t port;                  // UDP destination port
+    uint32_t seq;                   // SeqTsHeader sequence number
+};
+
+struct Capture {
+    std::vector<int64_t> times;     // record timestamps in us
+    std::vector<uint32_t> sizes;    // original frame lengths
+    std::vector<Frame> frames;      // headers of each record
+};
+
+uint32_t be32(const unsigned char *b)
+{
+    return (uint32_t) b[0] << 24 | (uint32_t) b[1] << 16 | (uint32_t) b[2] << 8 | b[3];
+}
+
+// PPP protocol, then IPv4, UDP and SeqTs headers; deflated and redundancy
+// eliminated frames keep their headers in the clear
+Frame parseFrame(const unsigned char *b, uint32_t len)
+{
+    Frame f = Frame();
+    if (len < 2) {
+        return f;
+    }
+    uint16_t protocol = b[0] << 8 | b[1];
+    if (protocol != 0x0021 && protocol != 0x4021 && protocol != 0x4023) {
+        return f;
+    }
+    b += 2;
+    len -= 2;
+    uint32_t ihl = (b[0] & 0x0f) * 4;
+    if (len < 20 || (b[0] >> 4) != 4 || ihl < 20) {
+        return f;
+    }
+    f.ipv4 = true;
+    f.src = be32(b + 12);
+    f.dst = be32(b + 16);
+    // UDP header then the 4 byte sequence number
+    if (b[9] == 17 && len >= ihl + 12) {
+        f.udp = true;
+        f.port = b[ihl + 2] << 8 | b[ihl + 3];
+        f.seq = be32(b + ihl + 8);
+    }
+    return f;
+}
+
+struct Run {
+    std::string tag;                // CN, CY or RE
+    std::string rate;
+    bool high;                      // high entropy
+    std::map<std::pair<int, int>, std::string> files; // (node, device) -> file
+};
+
+// Reads every record of a pcap file, returns false if it is not one
+bool readPcap(const std::string &name, Capture &cap)
+{
+    gzFile f = gzopen(name.c_str(), "rb");
+    if (f == NULL) {
+        return false;
+    }
+    gzbuffer(f, 1 << 20);
+
+    uint32_t header[6];
+    if (gzread(f, header, sizeof(header)) != (int) sizeof(header) || header[0] != 0xa1b2c3d4) {
+        gzclose(f);
+        return false;
+    }
+    uint32_t snapLen = header[4];
+    std::vector<char> skip(snapLen + 1);
+
+    uint32_t record[4];
+    while (gzread(f, record, sizeof(record)) == (int) sizeof(record)) {
+        cap.times.push_back((int64_t) record[0] * 1000000 + record[1]);
+        cap.sizes.push_back(record[3]);
+        uint32_t inclLen = record[2];
+        if (inclLen > skip.size()) {
+            skip.resize(inclLen);
+        }
+        if (gzread(f, &skip[0], inclLen) != (int) inclLen) {
+            cap.times.pop_back();
+            cap.sizes.pop_back();
+            break;
+        }
+        cap.frames.push_back(parseFrame((const unsigned char *) &skip[0], inclLen));
+    }
+    gzclose(f);
+    return true;
+}
+
+// Splits p1_CY__dr_5_ent_l--3-1.pcap into run "p1_CY__dr_5_ent_l", node 3, device 1
+bool parseName(const std::string &path, std::string &run, int &node, int &device)
+{
+    size_t ext = path.rfind(".pcap");
+    if (ext == std::string::npos) {
+        return false;
+    }
+    size_t d = path.rfind('-', ext);
+    if (d == std::string::npos || d == 0) {
+        return false;
+    }
+    size_t n = path.rfind('-', d - 1);
+    if (n == std::string::npos) {
+        return false;
+    }
+    node = atoi(path.substr(n + 1, d - n - 1).c_str());
+    device = atoi(path.substr(d + 1, ext - d - 1).c_str());
+    run = path.substr(0, n);
+    while (!run.empty() && run[run.size() - 1] == '-') {
+        run.erase(run.size() - 1);
+    }
+    return true;
+}
+
+// Finds the capture of device on the node with id % 4 == role
+const std::string *findFile(const Run &r, int role, int device)
+{
+    for (std::map<std::pair<int, int>, std::string>::const_iterator it = r.files.begin(); it != r.files.end(); ++it) {
+        if (it->first.first % 4 == role && it->first.second == device) {
+            return &it->second;
+        }
+    }
+    return NULL;
+}
+
+double percentile(std::vector<double> v, double q)
+{
+    if (v.empty()) {
+        return 0;
+    }
+    size_t k = std::min(v.size() - 1, (size_t) (q * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char* argv[])
+{
+    double threshold = 100;         // ms, as in cs621IdliP1
+    std::map<std::string, Run> runs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 12, "--threshold=") == 0) {
+            threshold = atof(arg.substr(12).c_str());
+            continue;
+        }
+        std::string run;
+        int node, device;
+        if (!parseName(arg, run, node, device)) {
+            fprintf(stderr, "skipping %s: not a cs621IdliP1 pcap name\n", arg.c_str());
+            continue;
+        }
+        Run &r = runs[run];
+        r.files[std::make_pair(node, device)] = arg;
+
+        std::string base = run.substr(run.find_last_of('/') + 1);
+        size_t dr = base.find("_dr_");
+        size_t ent = base.find("_ent_");
+        if (dr != std::string::npos && ent != std::string::npos) {
+            size_t under = base.find('_');
+            r.tag = base.substr(under + 1, base.find('_', under + 1) - under - 1);
+            r.rate = base.substr(dr + 4, ent - dr - 4);
+            r.high = base.compare(ent + 5, 1, "h") == 0;
+        }
+    }
+    if (runs.empty()) {
+        fprintf(stderr, "usage: %s [--threshold=ms] p1_*.pcap[.gz] ...\n", argv[0]);
+        return 1;
+    }
+
+    // delta in ms per (tag, rate) and entropy
+    std::map<std::pair<std::string, std::string>, std::map<bool, double> > deltas;
+
+    printf("run packets delta_ms gap_mean_ms gap_p50_ms gap_p99_ms bottleneck_frames size_mean size_min size_max\n");
+    for (std::map<std::string, Run>::iterator it = runs.begin(); it != runs.end(); ++it) {
+        Run &r = it->second;
+
+        Capture capture;
+        const std::string *server = findFile(r, 3, 1);
+        if (server == NULL || !readPcap(*server, capture) || capture.times.empty()) {
+            fprintf(stderr, "%s: no server capture\n", it->first.c_str());
+            continue;
+        }
+
+        // the measured flow's frames arriving at the server
+        int port = -1;
+        for (size_t k = 0; k < capture.frames.size(); k++) {
+            const Frame &f = capture.frames[k];
+            if (f.udp && f.dst > f.src && (port < 0 || f.port < port)) {
+                port = f.port;
+            }
+        }
+        if (port < 0) {
+            fprintf(stderr, "%s: no server bound UDP frame, is the snap length below 34 bytes?\n", it->first.c_str());
+            continue;
+        }
+        Capture arrivals;
+        uint32_t seqMin = UINT32_MAX, seqMax = 0;
+        for (size_t k = 0; k < capture.frames.size(); k++) {
+            const Frame &f = capture.frames[k];
+            if (f.udp && f.dst > f.src && f.port == port) {
+                arrivals.times.push_back(capture.times[k]);
+                seqMin = std::min(seqMin, f.seq);
+                seqMax = std::max(seqMax, f.seq);
+            }
+        }
+        uint64_t span = (uint64_t) seqMax - seqMin + 1;
+        if (arrivals.times.size() * 4 < span * 3) {
+            fprintf(stderr, "%s: %lu of %lu packets captured, thinned with --pcapSample or lossy, skipped\n",
+                    it->first.c_str(), (unsigned long) arrivals.times.size(), (unsigned long) span);
+            continue;
+        }
+
+        std::vector<double> gaps;
+        for (size_t k = 1; k < arrivals.times.size(); k++) {
+            gaps.push_back((arrivals.times[k] - arrivals.times[k - 1]) / 1000.0);
+        }
+        double gapSum = 0;
+        for (size_t k = 0; k < gaps.size(); k++) {
+            gapSum += gaps[k];
+        }
+        double delta = (arrivals.times.back() - arrivals.times.front()) / 1000.0;
+
+        // frames sent on ndc12, their sizes show what the codec achieved;
+        // frames coming back from the server are left out
+        Capture link;
+        Capture bottleneck;
+        const std::string *sender = findFile(r, 1, 2);
+        if (sender != NULL && readPcap(*sender, link)) {
+            for (size_t k = 0; k < link.frames.size(); k++) {
+                if (!link.frames[k].ipv4 || link.frames[k].dst > link.frames[k].src) {
+                    bottleneck.sizes.push_back(link.sizes[k]);
+                }
+            }
+        }
+        uint64_t sizeSum = 0;
+        uint32_t sizeMin = 0, sizeMax = 0;
+        if (!bottleneck.sizes.empty()) {
+            sizeMin = *std::min_element(bottleneck.sizes.begin(), bottleneck.sizes.end());
+            sizeMax = *std::max_element(bottleneck.sizes.begin(), bottleneck.sizes.end());
+            for (size_t k = 0; k < bottleneck.sizes.size(); k++) {
+                sizeSum += bottleneck.sizes[k];
+            }
+        }
+
+        printf("%s %lu %.3f %.4f %.4f %.4f %lu %.1f %u %u\n", it->first.c_str(),
+               (unsigned long) arrivals.times.size(), delta,
+               gaps.empty() ? 0 : gapSum / gaps.size(), percentile(gaps, 0.5), percentile(gaps, 0.99),
+               (unsigned long) bottleneck.sizes.size(),
+               bottleneck.sizes.empty() ? 0 : (double) sizeSum / bottleneck.sizes.size(), sizeMin, sizeMax);
+
+        if (!r.rate.empty()) {
+            deltas[std::make_pair(r.tag, r.rate)][r.high] = delta;
+        }
+    }
+
+    printf("\ncodec rate delta_ms detected\n");
+    for (std::map<std::pair<std::string, std::string>, std::map<bool, double> >::iterator it = deltas.begin();
+         it != deltas.end(); ++it) {
+        if (it->second.size() != 2) {
+            continue;
+        }
+        double d = it->second[true] - it->second[false];
+        printf("%s %s %.3f %d\n", it->first.first.c_str(), it->first.second.c_str(), d, d >= threshold ? 1 : 0);
+    }
+    return 0;
+}
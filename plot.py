@@ -6,16 +6,22 @@ Created on Mon Mar 25 01:06:35 2019
 @author: manalipatil
 """
 
+import csv
 import numpy as np
 import matplotlib.pyplot as plt
 
-data_file = np.loadtxt('Final.txt',delimiter=' ')
+# Rates.csv has a header line; a later row for the same rate replaces an
+# earlier one, so repeated sweeps plot their latest result
+rates = {0: {}, 1: {}}
+with open('Rates.csv', newline='') as f:
+    for row in csv.DictReader(f):
+        rates[int(row['compression'])][float(row['rate_mbps'])] = float(row['delta_ms'])
 
-datarate = data_file[0:10,0]
+datarate = np.array(sorted(set(rates[0]) | set(rates[1])))
 
-nocompression = data_file[0:10,1]
+nocompression = np.array([rates[0].get(r, np.nan) for r in datarate])
 
-compression = data_file[10:20,1]
+compression = np.array([rates[1].get(r, np.nan) for r in datarate])
 
 my_data = np.vstack((datarate,nocompression.T,compression))
 